@@ -0,0 +1,105 @@
+#ifndef _EMERALD_BITSET_H
+#define _EMERALD_BITSET_H
+
+#include <vector>
+#include <memory_resource>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace Emerald {
+
+    inline std::size_t countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(word);
+#else
+        std::size_t count = 0;
+        while((word & 1) == 0) {
+            word >>= 1;
+            count++;
+        }
+        return count;
+#endif
+    }
+
+    // Growable bitset that can skip over empty words when searching for set bits
+    class Bitset {
+    public:
+        typedef uint64_t word_t;
+        static constexpr std::size_t word_bits = 64;
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        Bitset(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_words(resource) {}
+
+        bool test(const std::size_t pos) const {
+            return pos / word_bits < m_words.size() && ((m_words[pos / word_bits] >> (pos % word_bits)) & 1);
+        }
+
+        void set(const std::size_t pos) {
+            if(pos / word_bits >= m_words.size()) {
+                m_words.resize(pos / word_bits + 1, 0);
+            }
+            m_words[pos / word_bits] |= word_t(1) << (pos % word_bits);
+        }
+
+        void reset(const std::size_t pos) {
+            if(pos / word_bits < m_words.size()) {
+                m_words[pos / word_bits] &= ~(word_t(1) << (pos % word_bits));
+            }
+        }
+
+        void clear() {
+            m_words.clear();
+        }
+
+        // Drops every word past the one holding bit count - 1 and gives back their memory
+        void truncate(const std::size_t count) {
+            m_words.resize(std::min(m_words.size(), (count + word_bits - 1) / word_bits));
+            m_words.shrink_to_fit();
+        }
+
+        std::size_t getBytes() const {
+            return m_words.capacity() * sizeof(word_t);
+        }
+
+        // Copies count words from memory that might not be aligned for them
+        void assign(const void* words, const std::size_t count) {
+            m_words.resize(count);
+            if(count > 0) {
+                std::memcpy(m_words.data(), words, count * sizeof(word_t));
+            }
+        }
+
+        std::size_t findNext(const std::size_t pos) const {
+            auto next = findNext(m_words.data(), pos, m_words.size() * word_bits);
+            return next < m_words.size() * word_bits ? next : npos;
+        }
+
+        const word_t* getWords() const {
+            return m_words.data();
+        }
+
+        std::size_t getWordCount() const {
+            return m_words.size();
+        }
+
+        // First set bit in [pos, end) of words, or end if there isn't one
+        static std::size_t findNext(const word_t* words, std::size_t pos, const std::size_t end) {
+            while(pos < end) {
+                if(auto word = words[pos / word_bits] >> (pos % word_bits); word != 0) {
+                    pos += countTrailingZeros(word);
+                    return pos < end ? pos : end;
+                }
+                pos = (pos / word_bits + 1) * word_bits;
+            }
+            return end;
+        }
+
+    private:
+        std::pmr::vector<word_t> m_words;
+    };
+
+};
+
+#endif // _EMERALD_BITSET_H
@@ -24,6 +24,11 @@ namespace Emerald {
     public:
         BadType(const std::string& error) : std::logic_error(error) {}
     };
+
+    class BadSnapshot : public std::runtime_error {
+    public:
+        BadSnapshot(const std::string& error) : std::runtime_error(error) {}
+    };
 };
 
 #endif // _EMERALD_EXCEPTIONS_H
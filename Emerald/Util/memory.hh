@@ -0,0 +1,166 @@
+#ifndef _EMERALD_MEMORY_H
+#define _EMERALD_MEMORY_H
+
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "types.hh"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#define EMERALD_HAS_HUGE_PAGES
+#endif
+
+namespace Emerald {
+
+    // Hands out memory by bumping a pointer through blocks taken from upstream, deallocating does nothing.
+    // reset() makes all of it available again, for scratch memory that only lives for a frame, and release()
+    // gives the blocks back to upstream, so a whole world can be reserved up front and freed in one go
+    class ArenaResource : public std::pmr::memory_resource {
+    public:
+        ArenaResource(const std::size_t reserve, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : m_upstream(upstream)
+        , m_nextSize(std::max<std::size_t>(reserve, 4096))
+        , m_current(0)
+        , m_offset(0) {
+            addBlock(m_nextSize);
+        }
+
+        ArenaResource(const ArenaResource&) = delete;
+        ArenaResource& operator=(const ArenaResource&) = delete;
+
+        ~ArenaResource() {
+            release();
+        }
+
+        // Everything handed out so far is invalid afterwards, the blocks are kept for reuse
+        void reset() {
+            m_current = 0;
+            m_offset = 0;
+        }
+
+        void release() {
+            for(auto& block : m_blocks) {
+                m_upstream->deallocate(block.data, block.size, block_alignment);
+            }
+            m_blocks.clear();
+            reset();
+        }
+
+        // Bytes handed out since the last reset, counting alignment padding
+        std::size_t getUsed() const {
+            std::size_t used = m_offset;
+            for(std::size_t i = 0; i < m_current && i < m_blocks.size(); i++) {
+                used += m_blocks[i].size;
+            }
+            return used;
+        }
+
+        std::size_t getReserved() const {
+            std::size_t reserved = 0;
+            for(auto& block : m_blocks) {
+                reserved += block.size;
+            }
+            return reserved;
+        }
+
+    private:
+        static constexpr std::size_t block_alignment = cache_line_size;
+
+        struct Block {
+            char* data;
+            std::size_t size;
+        };
+
+        void* do_allocate(const std::size_t bytes, const std::size_t alignment) override {
+            while(true) {
+                if(m_current < m_blocks.size()) {
+                    auto& block = m_blocks[m_current];
+                    auto address = reinterpret_cast<std::uintptr_t>(block.data) + m_offset;
+                    auto padding = (alignment - address % alignment) % alignment;
+                    if(m_offset + padding + bytes <= block.size) {
+                        m_offset += padding + bytes;
+                        return block.data + m_offset - bytes;
+                    }
+                    m_current++;
+                    m_offset = 0;
+                } else {
+                    m_nextSize *= 2;
+                    addBlock(std::max(m_nextSize, bytes + alignment));
+                }
+            }
+        }
+
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        void addBlock(const std::size_t size) {
+            m_blocks.push_back({static_cast<char*>(m_upstream->allocate(size, block_alignment)), size});
+        }
+
+        std::pmr::memory_resource* m_upstream;
+        std::vector<Block> m_blocks;
+        std::size_t m_nextSize;
+        std::size_t m_current;
+        std::size_t m_offset;
+    };
+
+    // Maps every allocation straight from the OS in 2MB huge pages where it can, through MAP_HUGETLB when huge
+    // pages are reserved and transparent huge pages otherwise. Every allocation takes at least one huge page,
+    // so it's meant as the upstream of an ArenaResource. Without huge page support it forwards to upstream
+    class HugePageResource : public std::pmr::memory_resource {
+    public:
+        static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+        HugePageResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : m_upstream(upstream) {}
+
+    private:
+        static std::size_t roundUp(const std::size_t bytes) {
+            return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+        }
+
+        void* do_allocate(const std::size_t bytes, const std::size_t alignment) override {
+#ifdef EMERALD_HAS_HUGE_PAGES
+            if(alignment <= 4096) {
+                auto size = roundUp(bytes);
+                auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if(data == MAP_FAILED) {
+                    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if(data == MAP_FAILED) {
+                        throw std::bad_alloc();
+                    }
+                    madvise(data, size, MADV_HUGEPAGE);
+                }
+                return data;
+            }
+#endif
+            return m_upstream->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* data, const std::size_t bytes, const std::size_t alignment) override {
+#ifdef EMERALD_HAS_HUGE_PAGES
+            if(alignment <= 4096) {
+                munmap(data, roundUp(bytes));
+                return;
+            }
+#endif
+            m_upstream->deallocate(data, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* m_upstream;
+    };
+
+};
+
+#endif // _EMERALD_MEMORY_H
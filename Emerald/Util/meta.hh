@@ -0,0 +1,34 @@
+#ifndef _EMERALD_META_H
+#define _EMERALD_META_H
+
+#include <cstddef>
+#include <type_traits>
+
+namespace Emerald {
+
+    template<typename t, typename... ts>
+    struct index_of;
+
+    template<typename t, typename... ts>
+    struct index_of<t, t, ts...> : std::integral_constant<std::size_t, 0> {};
+
+    template<typename t, typename u, typename... ts>
+    struct index_of<t, u, ts...> : std::integral_constant<std::size_t, 1 + index_of<t, ts...>::value> {};
+
+    template<typename t, typename... ts>
+    inline constexpr bool contains_v = (std::is_same_v<t, ts> || ...);
+
+    template<typename t>
+    struct type_tag {
+        typedef t type;
+    };
+
+    template<typename... ts>
+    struct is_unique : std::true_type {};
+
+    template<typename t, typename... ts>
+    struct is_unique<t, ts...> : std::bool_constant<!contains_v<t, ts...> && is_unique<ts...>::value> {};
+
+};
+
+#endif // _EMERALD_META_H
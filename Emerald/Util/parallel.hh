@@ -0,0 +1,115 @@
+#ifndef _EMERALD_PARALLEL_H
+#define _EMERALD_PARALLEL_H
+
+#include <vector>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <mutex>
+#include <exception>
+#include "types.hh"
+#include "threadpool.hh"
+#include "profiler.hh"
+
+namespace Emerald {
+
+    static constexpr std::size_t default_grain = 1024;
+
+    // Rounds grain up so every chunk of elem_t starts on a cache line, given an aligned base
+    template<typename elem_t>
+    constexpr std::size_t alignGrain(const std::size_t grain) {
+        constexpr std::size_t per_line = cache_line_size / std::gcd(cache_line_size, sizeof(elem_t));
+        return std::max<std::size_t>((grain + per_line - 1) / per_line * per_line, per_line);
+    }
+
+    // One value per thread that can run tasks in pool, padded so threads never share a cache line
+    template<typename local_t>
+    class PerThread {
+    public:
+        PerThread(ThreadPool* pool, const local_t& init = local_t())
+        : m_slots(pool != nullptr ? pool->getWorkerCount() : 1, Slot{init}) {}
+
+        local_t& operator[](const std::size_t worker) {
+            return m_slots[worker].value;
+        }
+
+        const local_t& operator[](const std::size_t worker) const {
+            return m_slots[worker].value;
+        }
+
+        std::size_t getSize() const {
+            return m_slots.size();
+        }
+
+        template<typename func_t>
+        local_t combine(func_t func) const {
+            local_t result = m_slots[0].value;
+            for(std::size_t i = 1; i < m_slots.size(); i++) {
+                result = func(result, m_slots[i].value);
+            }
+            return result;
+        }
+
+    private:
+        struct alignas(cache_line_size) Slot {
+            local_t value;
+        };
+
+        std::vector<Slot> m_slots;
+    };
+
+    // Calls func(begin, end, worker) for every grain sized chunk of [0, size). Chunks are handed out
+    // to the pool's threads as they free up, the calling thread works too. A null pool runs inline.
+    // If func throws no more chunks are handed out, and the first exception is rethrown once every
+    // thread has stopped
+    template<typename func_t>
+    void parallelFor(ThreadPool* pool, const std::size_t size, std::size_t grain, func_t func) {
+        grain = std::max<std::size_t>(grain, 1);
+        if(pool == nullptr || size <= grain) {
+            if(size > 0) {
+                func(0, size, pool != nullptr ? pool->getCurrentWorker() : 0);
+            }
+            return;
+        }
+        const std::size_t chunks = (size + grain - 1) / grain;
+        const std::size_t tasks = std::min(chunks, pool->getWorkerCount());
+        std::atomic<std::size_t> next(0);
+        std::atomic<std::size_t> finished(0);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+#ifdef EMERALD_PROFILE
+        auto& counters = profileCounters();
+#endif
+        auto task = [&] {
+#ifdef EMERALD_PROFILE
+            ProfileScope scope(counters);
+#endif
+            auto worker = pool->getCurrentWorker();
+            try {
+                for(auto chunk = next++; chunk < chunks; chunk = next++) {
+                    func(chunk * grain, std::min(size, (chunk + 1) * grain), worker);
+                }
+            } catch(...) {
+                next = chunks;
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!error) {
+                    error = std::current_exception();
+                }
+            }
+            finished++;
+        };
+        for(std::size_t i = 1; i < tasks; i++) {
+            pool->submit(task);
+        }
+        task();
+        pool->waitUntil([&finished, tasks] {
+            return finished == tasks;
+        });
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+};
+
+#endif // _EMERALD_PARALLEL_H
@@ -0,0 +1,269 @@
+#ifndef _EMERALD_PROFILER_H
+#define _EMERALD_PROFILER_H
+
+// Everything here is compiled out unless EMERALD_PROFILE is defined before Emerald is included
+
+#ifdef EMERALD_PROFILE
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <string>
+#include <typeinfo>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+#include "exceptions.hh"
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+#define EMERALD_PROFILE_VISITS(count) (::Emerald::profileCounters().visited.fetch_add((count), std::memory_order_relaxed))
+#define EMERALD_PROFILE_CHANGES(count) (::Emerald::profileCounters().changes.fetch_add((count), std::memory_order_relaxed))
+#define EMERALD_PROFILE_SPAN(profiler, name) ::Emerald::ProfileSpan emeraldProfileSpan((profiler), (name))
+
+namespace Emerald {
+
+    // Work is counted into whatever ProfileScope is open on the thread doing it. A system update opens one, and
+    // parallelFor opens the caller's on every thread it runs chunks on, so work on workers counts too
+    struct ProfileCounters {
+        std::atomic<std::size_t> visited{0};
+        std::atomic<std::size_t> changes{0};
+    };
+
+    inline ProfileCounters*& currentProfileCounters() {
+        thread_local ProfileCounters unscoped;
+        thread_local ProfileCounters* current = &unscoped;
+        return current;
+    }
+
+    inline ProfileCounters& profileCounters() {
+        return *currentProfileCounters();
+    }
+
+    // Counts work done on this thread into counters until the end of the scope, then goes back to the
+    // counters before it
+    class ProfileScope {
+    public:
+        ProfileScope(ProfileCounters& counters)
+        : m_previous(currentProfileCounters()) {
+            currentProfileCounters() = &counters;
+        }
+
+        ~ProfileScope() {
+            currentProfileCounters() = m_previous;
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        ProfileCounters* m_previous;
+    };
+
+    // Keeps the last window samples, percentiles are worked out when asked for
+    class RollingHistogram {
+    public:
+        RollingHistogram(const std::size_t window = 512)
+        : m_window(window)
+        , m_next(0) {}
+
+        void add(const double sample) {
+            if(m_samples.size() < m_window) {
+                m_samples.push_back(sample);
+            } else {
+                m_samples[m_next] = sample;
+                m_next = (m_next + 1) % m_window;
+            }
+        }
+
+        // p between 0 and 1, 0 when there are no samples
+        double percentile(const double p) const {
+            if(m_samples.size() == 0) {
+                return 0;
+            }
+            auto sorted = m_samples;
+            auto nth = sorted.begin() + std::min<std::size_t>(p * sorted.size(), sorted.size() - 1);
+            std::nth_element(sorted.begin(), nth, sorted.end());
+            return *nth;
+        }
+
+        double max() const {
+            return m_samples.size() > 0 ? *std::max_element(m_samples.begin(), m_samples.end()) : 0;
+        }
+
+        std::size_t getCount() const {
+            return m_samples.size();
+        }
+
+    private:
+        std::size_t m_window;
+        std::size_t m_next;
+        std::vector<double> m_samples;
+    };
+
+    // Times are in microseconds
+    struct SystemProfile {
+        std::string name;
+        RollingHistogram time;
+        std::size_t updates = 0;
+        std::size_t visited = 0;
+        std::size_t changes = 0;
+    };
+
+    // Records how long every system update took with the entities it visited and the structural changes it
+    // made, and keeps every span for a Chrome trace (chrome://tracing or Perfetto) until the trace is cleared
+    class Profiler {
+    public:
+        typedef std::chrono::steady_clock clock_t;
+
+        static constexpr std::size_t max_spans = 1 << 20;
+
+        Profiler()
+        : m_epoch(clock_t::now()) {}
+
+        static clock_t::time_point now() {
+            return clock_t::now();
+        }
+
+        template<typename system_t>
+        void addSystem() {
+            m_systems.push_back({demangle(typeid(system_t).name()), RollingHistogram(), 0, 0, 0});
+        }
+
+        // A system is only ever updated by one thread at a time, so its own profile needs no lock
+        void recordSystem(const std::size_t index, const clock_t::time_point start, const clock_t::time_point end,
+                          const std::size_t visited, const std::size_t changes) {
+            auto& system = m_systems[index];
+            system.time.add(std::chrono::duration<double, std::micro>(end - start).count());
+            system.updates++;
+            system.visited = visited;
+            system.changes = changes;
+            addSpan(system.name.c_str(), start, end, visited, changes);
+        }
+
+        void recordSpan(const char* name, const clock_t::time_point start, const clock_t::time_point end) {
+            addSpan(name, start, end, 0, 0);
+        }
+
+        const std::deque<SystemProfile>& getSystems() const {
+            return m_systems;
+        }
+
+        // Writes the trace event format, one complete event per span with the thread that ran it
+        void writeChromeTrace(const std::string& path) const {
+            std::ofstream file(path, std::ios::trunc);
+            if(!file) {
+                throw std::runtime_error("Couldn't open " + path + " for writing");
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            file << std::fixed << std::setprecision(3);
+            for(std::size_t i = 0; i < m_spans.size(); i++) {
+                auto& span = m_spans[i];
+                file << (i > 0 ? ",\n" : "\n") << "{\"name\":\"" << escape(span.name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << span.thread
+                     << ",\"ts\":" << span.start << ",\"dur\":" << span.duration << ",\"args\":{\"visited\":" << span.visited
+                     << ",\"changes\":" << span.changes << "}}";
+            }
+            file << "\n]}\n";
+        }
+
+        void clearTrace() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_spans.clear();
+        }
+
+        // One line per system with the time percentiles over its recent updates
+        void report(std::ostream& out) const {
+            for(auto& system : m_systems) {
+                out << system.name << ": p50 " << system.time.percentile(0.5) << "us, p99 " << system.time.percentile(0.99)
+                    << "us, max " << system.time.max() << "us, " << system.visited << " visited, " << system.changes << " changes\n";
+            }
+        }
+
+    private:
+        struct Span {
+            const char* name;
+            std::size_t thread;
+            double start;
+            double duration;
+            std::size_t visited;
+            std::size_t changes;
+        };
+
+        void addSpan(const char* name, const clock_t::time_point start, const clock_t::time_point end,
+                     const std::size_t visited, const std::size_t changes) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_spans.size() < max_spans) {
+                auto thread = m_threads.emplace(std::this_thread::get_id(), m_threads.size()).first->second;
+                m_spans.push_back({name, thread, std::chrono::duration<double, std::micro>(start - m_epoch).count(),
+                                   std::chrono::duration<double, std::micro>(end - start).count(), visited, changes});
+            }
+        }
+
+        static std::string demangle(const char* name) {
+#if defined(__GNUG__)
+            int status = 0;
+            if(char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status); status == 0) {
+                std::string result(demangled);
+                std::free(demangled);
+                return result;
+            }
+#endif
+            return name;
+        }
+
+        static std::string escape(const char* name) {
+            std::string result;
+            for(; *name != '\0'; name++) {
+                if(*name == '"' || *name == '\\') {
+                    result += '\\';
+                }
+                result += *name;
+            }
+            return result;
+        }
+
+        clock_t::time_point m_epoch;
+        // Spans point at the names, so they can't move
+        std::deque<SystemProfile> m_systems;
+        mutable std::mutex m_mutex;
+        std::vector<Span> m_spans;
+        std::unordered_map<std::thread::id, std::size_t> m_threads;
+    };
+
+    // Records a span from its construction to the end of the scope
+    class ProfileSpan {
+    public:
+        ProfileSpan(Profiler& profiler, const char* name)
+        : m_profiler(profiler)
+        , m_name(name)
+        , m_start(Profiler::now()) {}
+
+        ~ProfileSpan() {
+            m_profiler.recordSpan(m_name, m_start, Profiler::now());
+        }
+
+    private:
+        Profiler& m_profiler;
+        const char* m_name;
+        Profiler::clock_t::time_point m_start;
+    };
+
+};
+
+#else
+
+#define EMERALD_PROFILE_VISITS(count) ((void)0)
+#define EMERALD_PROFILE_CHANGES(count) ((void)0)
+#define EMERALD_PROFILE_SPAN(profiler, name) ((void)0)
+
+#endif // EMERALD_PROFILE
+
+#endif // _EMERALD_PROFILER_H
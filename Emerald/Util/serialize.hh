@@ -0,0 +1,205 @@
+#ifndef _EMERALD_SERIALIZE_H
+#define _EMERALD_SERIALIZE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <type_traits>
+#include "types.hh"
+#include "exceptions.hh"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define EMERALD_HAS_MMAP
+#endif
+
+namespace Emerald {
+
+    static constexpr char snapshot_magic[8] = {'E', 'M', 'E', 'R', 'A', 'L', 'D', 'S'};
+    static constexpr char delta_magic[8] = {'E', 'M', 'E', 'R', 'A', 'L', 'D', 'D'};
+    static constexpr uint32_t snapshot_version = 2;
+
+    // Writes to a file, or appends to a buffer in memory
+    class SnapshotWriter {
+    public:
+        SnapshotWriter(const std::string& path)
+        : m_file(path, std::ios::binary | std::ios::trunc)
+        , m_buffer(nullptr) {
+            if(!m_file) {
+                throw BadSnapshot("Couldn't open " + path + " for writing");
+            }
+        }
+
+        SnapshotWriter(std::vector<char>& buffer)
+        : m_buffer(&buffer) {}
+
+        void write(const void* data, const std::size_t bytes) {
+            if(m_buffer != nullptr) {
+                m_buffer->insert(m_buffer->end(), static_cast<const char*>(data), static_cast<const char*>(data) + bytes);
+            } else if(bytes > 0 && !m_file.write(static_cast<const char*>(data), bytes)) {
+                throw BadSnapshot("Snapshot write failed");
+            }
+        }
+
+        template<typename value_t>
+        void write(const value_t& value) {
+            static_assert(std::is_trivially_copyable<value_t>::value, "Only trivially copyable values can be written directly");
+            write(&value, sizeof(value_t));
+        }
+
+        void write(const std::string& value) {
+            write<uint64_t>(value.size());
+            write(value.data(), value.size());
+        }
+
+    private:
+        std::ofstream m_file;
+        std::vector<char>* m_buffer;
+    };
+
+    // Reads from memory that holds a whole snapshot, reading past its end throws
+    class SnapshotReader {
+    public:
+        SnapshotReader(const char* data, const std::size_t size)
+        : m_data(data)
+        , m_size(size)
+        , m_offset(0) {}
+
+        // Returns where the next bytes start and skips them, for copying large blocks straight out
+        const char* read(const std::size_t bytes) {
+            if(bytes > m_size - m_offset) {
+                throw BadSnapshot("Snapshot is truncated");
+            }
+            auto data = m_data + m_offset;
+            m_offset += bytes;
+            return data;
+        }
+
+        void readInto(void* destination, const std::size_t bytes) {
+            auto data = read(bytes);
+            if(bytes > 0) {
+                std::memcpy(destination, data, bytes);
+            }
+        }
+
+        template<typename value_t>
+        value_t read() {
+            static_assert(std::is_trivially_copyable<value_t>::value, "Only trivially copyable values can be read directly");
+            value_t value;
+            std::memcpy(&value, read(sizeof(value_t)), sizeof(value_t));
+            return value;
+        }
+
+        std::size_t getRemaining() const {
+            return m_size - m_offset;
+        }
+
+        std::string readString() {
+            auto size = read<uint64_t>();
+            auto data = read(size);
+            return std::string(data, size);
+        }
+
+    private:
+        const char* m_data;
+        std::size_t m_size;
+        std::size_t m_offset;
+    };
+
+    // Maps a file read only, or reads it into memory where mmap isn't available
+    class MappedFile {
+    public:
+        MappedFile(const std::string& path) {
+#ifdef EMERALD_HAS_MMAP
+            m_fd = open(path.c_str(), O_RDONLY);
+            struct stat info;
+            if(m_fd < 0 || fstat(m_fd, &info) != 0) {
+                close();
+                throw BadSnapshot("Couldn't open " + path);
+            }
+            m_size = info.st_size;
+            if(m_size > 0) {
+                auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+                if(data == MAP_FAILED) {
+                    close();
+                    throw BadSnapshot("Couldn't map " + path);
+                }
+                madvise(data, m_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const char*>(data);
+            }
+#else
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if(!file) {
+                throw BadSnapshot("Couldn't open " + path);
+            }
+            m_buffer.resize(file.tellg());
+            file.seekg(0);
+            file.read(m_buffer.data(), m_buffer.size());
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+            close();
+        }
+
+        const char* getData() const {
+            return m_data;
+        }
+
+        std::size_t getSize() const {
+            return m_size;
+        }
+
+    private:
+        void close() {
+#ifdef EMERALD_HAS_MMAP
+            if(m_data != nullptr) {
+                munmap(const_cast<char*>(m_data), m_size);
+                m_data = nullptr;
+            }
+            if(m_fd >= 0) {
+                ::close(m_fd);
+                m_fd = -1;
+            }
+#endif
+        }
+
+        const char* m_data = nullptr;
+        std::size_t m_size = 0;
+#ifdef EMERALD_HAS_MMAP
+        int m_fd = -1;
+#else
+        std::vector<char> m_buffer;
+#endif
+    };
+
+    // Specialize with write(SnapshotWriter&, const comp_t&) and comp_t read(SnapshotReader&) for components
+    // that aren't trivially copyable, trivially copyable ones are written as raw bytes unless specialized
+    template<typename comp_t>
+    struct Serializer;
+
+    template<typename comp_t, typename = void>
+    struct has_serializer : std::false_type {};
+
+    template<typename comp_t>
+    struct has_serializer<comp_t, std::void_t<decltype(Serializer<comp_t>::read(std::declval<SnapshotReader&>()))>> : std::true_type {};
+
+    template<typename comp_t>
+    inline constexpr bool has_serializer_v = has_serializer<comp_t>::value;
+
+    // Components that can be copied in and out of snapshots a whole page at a time
+    template<typename comp_t>
+    inline constexpr bool is_raw_serializable_v = std::is_trivially_copyable<comp_t>::value && !has_serializer_v<comp_t>;
+
+};
+
+#endif // _EMERALD_SERIALIZE_H
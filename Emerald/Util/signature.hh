@@ -0,0 +1,68 @@
+#ifndef _EMERALD_SIGNATURE_H
+#define _EMERALD_SIGNATURE_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// How many component types one entity manager can use, registered and not
+#ifndef EMERALD_MAX_COMPONENTS
+#define EMERALD_MAX_COMPONENTS 64
+#endif
+
+namespace Emerald {
+
+    // Which components an entity has, one bit for every component type its manager has a pool for
+    class Signature {
+    public:
+        typedef uint64_t word_t;
+        static constexpr std::size_t max_components = EMERALD_MAX_COMPONENTS;
+        static constexpr std::size_t word_bits = 64;
+        static constexpr std::size_t word_count = (max_components + word_bits - 1) / word_bits;
+
+        void set(const std::size_t bit) {
+            m_words[bit / word_bits] |= word_t(1) << (bit % word_bits);
+        }
+
+        void reset(const std::size_t bit) {
+            m_words[bit / word_bits] &= ~(word_t(1) << (bit % word_bits));
+        }
+
+        bool test(const std::size_t bit) const {
+            return (m_words[bit / word_bits] >> (bit % word_bits)) & 1;
+        }
+
+        bool none() const {
+            word_t any = 0;
+            for(std::size_t i = 0; i < word_count; i++) {
+                any |= m_words[i];
+            }
+            return any == 0;
+        }
+
+        // Has every bit set in mask
+        bool contains(const Signature& mask) const {
+            word_t missing = 0;
+            for(std::size_t i = 0; i < word_count; i++) {
+                missing |= mask.m_words[i] & ~m_words[i];
+            }
+            return missing == 0;
+        }
+
+    private:
+        std::array<word_t, word_count> m_words{};
+    };
+
+    // Bit i of the result is set when signatures[i] contains mask, count is at most 64. Written without
+    // branches so the loop vectorizes
+    inline uint64_t matchSignatures(const Signature* signatures, const std::size_t count, const Signature& mask) {
+        uint64_t hits = 0;
+        for(std::size_t i = 0; i < count; i++) {
+            hits |= uint64_t(signatures[i].contains(mask)) << i;
+        }
+        return hits;
+    }
+
+};
+
+#endif // _EMERALD_SIGNATURE_H
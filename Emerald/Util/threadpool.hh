@@ -0,0 +1,144 @@
+#ifndef _EMERALD_THREAD_POOL_H
+#define _EMERALD_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+namespace Emerald {
+
+    // Work stealing pool: every worker pops its own queue from the back and steals from the front of
+    // the others. Threads that aren't workers (like the one waiting on a batch) help by stealing too.
+    class ThreadPool {
+    public:
+        ThreadPool(const std::size_t threads = std::max(std::thread::hardware_concurrency(), 2u) - 1)
+        : m_queues(threads + 1)
+        , m_pending(0)
+        , m_stop(false) {
+            for(auto& queue : m_queues) {
+                queue = std::make_unique<WorkQueue>();
+            }
+            for(std::size_t i = 0; i < threads; i++) {
+                m_threads.emplace_back([this, i] {
+                    workerLoop(i + 1);
+                });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                m_stop = true;
+            }
+            m_wakeup.notify_all();
+            for(auto& thread : m_threads) {
+                thread.join();
+            }
+        }
+
+        // Number of threads that can run tasks, including the one that waits
+        std::size_t getWorkerCount() const {
+            return m_queues.size();
+        }
+
+        // 1..n on the pool's own threads, 0 on any other thread
+        std::size_t getCurrentWorker() const {
+            return t_pool == this ? t_worker : 0;
+        }
+
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                m_pending++;
+            }
+            {
+                auto& queue = *m_queues[getCurrentWorker()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+            m_wakeup.notify_one();
+        }
+
+        // Runs queued tasks on the calling thread until done() returns true
+        template<typename pred_t>
+        void waitUntil(pred_t done) {
+            auto worker = getCurrentWorker();
+            while(!done()) {
+                if(!runTask(worker)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+    private:
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        bool runTask(const std::size_t worker) {
+            std::function<void()> task;
+            {
+                auto& queue = *m_queues[worker];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if(queue.tasks.size() > 0) {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                }
+            }
+            for(std::size_t i = 1; !task && i < m_queues.size(); i++) {
+                auto& queue = *m_queues[(worker + i) % m_queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if(queue.tasks.size() > 0) {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+            }
+            if(!task) {
+                return false;
+            }
+            m_pending--;
+            task();
+            return true;
+        }
+
+        void workerLoop(const std::size_t worker) {
+            t_pool = this;
+            t_worker = worker;
+            while(true) {
+                if(runTask(worker)) {
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+                m_wakeup.wait(lock, [this] {
+                    return m_stop || m_pending > 0;
+                });
+                if(m_stop) {
+                    return;
+                }
+            }
+        }
+
+        inline static thread_local const ThreadPool* t_pool = nullptr;
+        inline static thread_local std::size_t t_worker = 0;
+
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;
+        std::vector<std::thread> m_threads;
+        std::atomic<std::size_t> m_pending;
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeup;
+        bool m_stop;
+    };
+
+};
+
+#endif // _EMERALD_THREAD_POOL_H
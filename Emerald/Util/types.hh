@@ -2,14 +2,45 @@
 #define _EMERALD_TYPES_H
 
 #include <cstdint>
+#include <cstddef>
 
 namespace Emerald {
 
-    typedef uint32_t emerald_long;
-    typedef uint16_t emerald_id;
-    static constexpr emerald_id invalid_id = 0xFFFF;
-    static constexpr emerald_long comp_type_mask = 0xFFFF0000;
-    static constexpr emerald_long comp_id_mask = 0x0000FFFF;
+    typedef uint64_t emerald_long;
+    typedef uint32_t emerald_id;
+    static constexpr emerald_id invalid_id = 0xFFFFFFFF;
+    // Change tracking ticks are 64 bit so they never wrap, even with thousands of system updates a second
+    typedef uint64_t emerald_tick;
+    static constexpr std::size_t cache_line_size = 64;
+
+    // Entity handles pack an index into the entity table with a generation that is bumped every time
+    // the index is recycled, so handles to destroyed entities can be detected. Define
+    // EMERALD_32BIT_ENTITIES for 32 bit handles (20 bit index, 12 bit generation), otherwise handles
+    // are 64 bit (32 bit index, 32 bit generation)
+#ifdef EMERALD_32BIT_ENTITIES
+    typedef uint32_t emerald_entity;
+    static constexpr unsigned entity_index_bits = 20;
+#else
+    typedef uint64_t emerald_entity;
+    static constexpr unsigned entity_index_bits = 32;
+#endif
+
+    static constexpr emerald_entity entity_index_mask = (emerald_entity(1) << entity_index_bits) - 1;
+    static constexpr emerald_entity entity_generation_mask = ~emerald_entity(0) >> entity_index_bits;
+    static constexpr emerald_entity invalid_entity = ~emerald_entity(0);
+    static constexpr emerald_id max_entities = entity_index_mask;
+
+    constexpr emerald_id entityIndex(const emerald_entity entity) {
+        return static_cast<emerald_id>(entity & entity_index_mask);
+    }
+
+    constexpr emerald_entity entityGeneration(const emerald_entity entity) {
+        return entity >> entity_index_bits;
+    }
+
+    constexpr emerald_entity makeEntity(const emerald_id index, const emerald_entity generation) {
+        return ((generation & entity_generation_mask) << entity_index_bits) | (index & entity_index_mask);
+    }
 
 };
 
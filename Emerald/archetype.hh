@@ -0,0 +1,436 @@
+#ifndef _EMERALD_ARCHETYPE_H
+#define _EMERALD_ARCHETYPE_H
+
+#include <vector>
+#include <memory>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <new>
+#include "Util/types.hh"
+#include "Util/exceptions.hh"
+#include "component.hh"
+
+namespace Emerald {
+
+    // Everything an archetype needs to know to move and destroy a component it only knows by id
+    struct ComponentInfo {
+        emerald_id id;
+        std::size_t size;
+        std::size_t align;
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void* ptr);
+
+        template<typename comp_t>
+        static const ComponentInfo* get() {
+            static const ComponentInfo info {
+                getComponentID<comp_t>(),
+                sizeof(comp_t),
+                alignof(comp_t),
+                [](void* dst, void* src) {
+                    new(dst) comp_t(std::move(*static_cast<comp_t*>(src)));
+                },
+                [](void* ptr) {
+                    static_cast<comp_t*>(ptr)->~comp_t();
+                }
+            };
+            return &info;
+        }
+    };
+
+    // Stores every entity that has exactly the same set of components. Rows live in fixed size chunks,
+    // each chunk holding one contiguous column per component. Every chunk but the last is always full.
+    class Archetype {
+    public:
+        static constexpr std::size_t chunk_alignment = 64;
+
+        Archetype(std::vector<const ComponentInfo*> infos, const std::size_t chunkBytes)
+        : m_infos(std::move(infos))
+        , m_offsets(m_infos.size())
+        , m_chunkCapacity(0)
+        , m_chunkBytes(chunkBytes)
+        , m_size(0) {
+            std::sort(m_infos.begin(), m_infos.end(), [](auto a, auto b) {
+                return a->id < b->id;
+            });
+            std::size_t rowBytes = sizeof(emerald_entity);
+            for(auto info : m_infos) {
+                rowBytes += info->size;
+            }
+            m_chunkCapacity = std::max<std::size_t>(m_chunkBytes / rowBytes, 1);
+            while(layoutChunk() > m_chunkBytes && m_chunkCapacity > 1) {
+                m_chunkCapacity--;
+            }
+            m_chunkBytes = std::max(m_chunkBytes, layoutChunk());
+        }
+
+        Archetype(const Archetype&) = delete;
+        Archetype& operator=(const Archetype&) = delete;
+
+        ~Archetype() {
+            for(std::size_t row = 0; row < m_size; row++) {
+                destroyRow(row);
+            }
+            for(auto chunk : m_chunks) {
+                ::operator delete(chunk, std::align_val_t(chunk_alignment));
+            }
+        }
+
+        const std::vector<const ComponentInfo*>& getComponentInfos() const {
+            return m_infos;
+        }
+
+        std::size_t getColumn(const emerald_id compID) const {
+            for(std::size_t i = 0; i < m_infos.size(); i++) {
+                if(m_infos[i]->id == compID) {
+                    return i;
+                }
+            }
+            return invalid_column;
+        }
+
+        bool hasType(const emerald_id compID) const {
+            return getColumn(compID) != invalid_column;
+        }
+
+        template<typename... comp_ts>
+        bool hasTypes() const {
+            return (hasType(getComponentID<comp_ts>()) && ...);
+        }
+
+        std::size_t getSize() const {
+            return m_size;
+        }
+
+        std::size_t getChunkCount() const {
+            return (m_size + m_chunkCapacity - 1) / m_chunkCapacity;
+        }
+
+        std::size_t getChunkCapacity() const {
+            return m_chunkCapacity;
+        }
+
+        std::size_t getChunkSize(const std::size_t chunk) const {
+            return std::min(m_chunkCapacity, m_size - chunk * m_chunkCapacity);
+        }
+
+        emerald_entity* getEntities(const std::size_t chunk) {
+            return reinterpret_cast<emerald_entity*>(m_chunks[chunk]);
+        }
+
+        emerald_entity getEntity(const std::size_t row) const {
+            return reinterpret_cast<const emerald_entity*>(m_chunks[row / m_chunkCapacity])[row % m_chunkCapacity];
+        }
+
+        template<typename comp_t>
+        comp_t* getColumnData(const std::size_t chunk) {
+            return reinterpret_cast<comp_t*>(m_chunks[chunk] + m_offsets[getColumn(getComponentID<comp_t>())]);
+        }
+
+        void* get(const std::size_t column, const std::size_t row) {
+            return m_chunks[row / m_chunkCapacity] + m_offsets[column] + (row % m_chunkCapacity) * m_infos[column]->size;
+        }
+
+        // Reserves a row for entID, the caller is responsible for constructing every component in it
+        std::size_t allocateRow(const emerald_entity entID) {
+            if(m_size == m_chunks.size() * m_chunkCapacity) {
+                m_chunks.push_back(static_cast<char*>(::operator new(m_chunkBytes, std::align_val_t(chunk_alignment))));
+            }
+            auto row = m_size++;
+            reinterpret_cast<emerald_entity*>(m_chunks[row / m_chunkCapacity])[row % m_chunkCapacity] = entID;
+            return row;
+        }
+
+        void destroyRow(const std::size_t row) {
+            for(std::size_t col = 0; col < m_infos.size(); col++) {
+                m_infos[col]->destroy(get(col, row));
+            }
+        }
+
+        // Fills an already destroyed row with the last row, returns the entity that was moved or invalid_entity
+        emerald_entity removeRow(const std::size_t row) {
+            auto last = --m_size;
+            emerald_entity moved = invalid_entity;
+            if(row != last) {
+                for(std::size_t col = 0; col < m_infos.size(); col++) {
+                    m_infos[col]->move(get(col, row), get(col, last));
+                    m_infos[col]->destroy(get(col, last));
+                }
+                moved = getEntity(last);
+                reinterpret_cast<emerald_entity*>(m_chunks[row / m_chunkCapacity])[row % m_chunkCapacity] = moved;
+            }
+            if(m_chunks.size() > getChunkCount() + 1) {
+                ::operator delete(m_chunks.back(), std::align_val_t(chunk_alignment));
+                m_chunks.pop_back();
+            }
+            return moved;
+        }
+
+        Archetype* getAddEdge(const emerald_id compID) const {
+            auto iter = m_addEdges.find(compID);
+            return iter != m_addEdges.end() ? iter->second : nullptr;
+        }
+
+        Archetype* getRemoveEdge(const emerald_id compID) const {
+            auto iter = m_removeEdges.find(compID);
+            return iter != m_removeEdges.end() ? iter->second : nullptr;
+        }
+
+        void setAddEdge(const emerald_id compID, Archetype* archetype) {
+            m_addEdges[compID] = archetype;
+        }
+
+        void setRemoveEdge(const emerald_id compID, Archetype* archetype) {
+            m_removeEdges[compID] = archetype;
+        }
+
+        static constexpr std::size_t invalid_column = static_cast<std::size_t>(-1);
+
+    private:
+        std::size_t layoutChunk() {
+            std::size_t offset = sizeof(emerald_entity) * m_chunkCapacity;
+            for(std::size_t i = 0; i < m_infos.size(); i++) {
+                auto align = m_infos[i]->align;
+                offset = (offset + align - 1) / align * align;
+                m_offsets[i] = offset;
+                offset += m_infos[i]->size * m_chunkCapacity;
+            }
+            return offset;
+        }
+
+        std::vector<const ComponentInfo*> m_infos;
+        std::vector<std::size_t> m_offsets;
+        std::vector<char*> m_chunks;
+        std::size_t m_chunkCapacity;
+        std::size_t m_chunkBytes;
+        std::size_t m_size;
+        std::unordered_map<emerald_id, Archetype*> m_addEdges;
+        std::unordered_map<emerald_id, Archetype*> m_removeEdges;
+    };
+
+    // Alternative to EntityManager that groups entities by component set, queries walk whole chunks
+    // in lockstep instead of looking up every entity's components
+    class ArchetypeManager {
+    public:
+        static constexpr std::size_t default_chunk_size = 16 * 1024;
+
+        ArchetypeManager(const std::size_t chunkBytes = default_chunk_size)
+        : m_chunkBytes(chunkBytes)
+        , m_entityCount(0) {
+            m_emptyArchetype = findArchetype({});
+        }
+
+        ArchetypeManager(const ArchetypeManager&) = delete;
+        ArchetypeManager& operator=(const ArchetypeManager&) = delete;
+
+        emerald_entity createEntity() {
+            emerald_entity id;
+            if(m_freeEntities.size() > 0) {
+                auto index = m_freeEntities.back();
+                m_freeEntities.pop_back();
+                id = makeEntity(index, entityGeneration(m_locations[index].entity) + 1);
+            } else if(m_locations.size() < max_entities) {
+                id = makeEntity(m_locations.size(), 0);
+                m_locations.push_back({nullptr, 0, id});
+            } else {
+                throw BadID("createEntity entity limit reached");
+            }
+            m_locations[entityIndex(id)] = {m_emptyArchetype, m_emptyArchetype->allocateRow(id), id};
+            m_entityCount++;
+            return id;
+        }
+
+        void removeEntity(const emerald_entity id) {
+            if(isEntityValid(id)) {
+                auto [archetype, row, entity] = m_locations[entityIndex(id)];
+                archetype->destroyRow(row);
+                if(auto moved = archetype->removeRow(row); moved != invalid_entity) {
+                    m_locations[entityIndex(moved)].row = row;
+                }
+                m_locations[entityIndex(id)].archetype = nullptr;
+                m_freeEntities.push_back(entityIndex(id));
+                m_entityCount--;
+            }
+        }
+
+        bool isEntityValid(const emerald_entity id) const {
+            auto index = entityIndex(id);
+            return index < m_locations.size()
+                && m_locations[index].archetype != nullptr
+                && m_locations[index].entity == id;
+        }
+
+        std::size_t getEntityCount() const {
+            return m_entityCount;
+        }
+
+        template<typename comp_t>
+        bool entityHasComponent(const emerald_entity entID) const {
+            return isEntityValid(entID) && m_locations[entityIndex(entID)].archetype->hasType(getComponentID<comp_t>());
+        }
+
+        template<typename... comp_ts>
+        bool entityHasComponents(const emerald_entity entID) const {
+            return (entityHasComponent<comp_ts>(entID) && ...);
+        }
+
+        // The returned reference is only valid until the entity's component set next changes. If the
+        // constructor throws the entity keeps the components it had
+        template<typename comp_t, typename... args_t>
+        std::enable_if_t<std::is_constructible<comp_t, args_t...>::value, comp_t&> createComponent(const emerald_entity id, args_t&&... args) {
+            auto& location = getLocation(id);
+            auto compID = getComponentID<comp_t>();
+            if(auto column = location.archetype->getColumn(compID); column != Archetype::invalid_column) {
+                return *static_cast<comp_t*>(location.archetype->get(column, location.row));
+            }
+            auto target = location.archetype->getAddEdge(compID);
+            if(target == nullptr) {
+                auto infos = location.archetype->getComponentInfos();
+                infos.push_back(ComponentInfo::get<comp_t>());
+                target = findArchetype(std::move(infos));
+                location.archetype->setAddEdge(compID, target);
+                target->setRemoveEdge(compID, location.archetype);
+            }
+            auto row = target->allocateRow(id);
+            auto ptr = static_cast<comp_t*>(target->get(target->getColumn(compID), row));
+            try {
+                new(ptr) comp_t(std::forward<args_t>(args)...);
+            } catch(...) {
+                target->removeRow(row);
+                throw;
+            }
+            moveEntity(id, target, row);
+            return *ptr;
+        }
+
+        template<typename comp_t>
+        void removeComponent(const emerald_entity id) {
+            auto& location = getLocation(id);
+            auto compID = getComponentID<comp_t>();
+            if(!location.archetype->hasType(compID)) {
+                return;
+            }
+            auto target = location.archetype->getRemoveEdge(compID);
+            if(target == nullptr) {
+                auto infos = location.archetype->getComponentInfos();
+                infos.erase(std::find(infos.begin(), infos.end(), ComponentInfo::get<comp_t>()));
+                target = findArchetype(std::move(infos));
+                location.archetype->setRemoveEdge(compID, target);
+                target->setAddEdge(compID, location.archetype);
+            }
+            moveEntity(id, target, target->allocateRow(id));
+        }
+
+        template<typename comp_t>
+        comp_t& getComponent(const emerald_entity id) {
+            auto& location = getLocation(id);
+            if(auto column = location.archetype->getColumn(getComponentID<comp_t>()); column != Archetype::invalid_column) {
+                return *static_cast<comp_t*>(location.archetype->get(column, location.row));
+            } else {
+                throw BadType("getComponent Entity doesn't have component");
+            }
+        }
+
+        template<typename comp_t>
+        const comp_t& getComponent(const emerald_entity id) const {
+            return const_cast<ArchetypeManager*>(this)->getComponent<comp_t>(id);
+        }
+
+        // The archetype holding entities with exactly comp_ts, nullptr if none ever did
+        template<typename... comp_ts>
+        Archetype* getArchetype() {
+            std::vector<emerald_id> key {getComponentID<comp_ts>()...};
+            std::sort(key.begin(), key.end());
+            auto iter = m_archetypeIndex.find(key);
+            return iter != m_archetypeIndex.end() ? iter->second : nullptr;
+        }
+
+        template<typename... comp_ts, typename func_t>
+        void mapEntities(func_t&& func) {
+            for(auto& archetype : m_archetypes) {
+                if(archetype->hasTypes<comp_ts...>()) {
+                    for(std::size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+                        auto entities = archetype->getEntities(chunk);
+                        for(std::size_t i = 0, size = archetype->getChunkSize(chunk); i < size; i++) {
+                            func(entities[i]);
+                        }
+                    }
+                }
+            }
+        }
+
+        template<typename... comp_ts, typename func_t>
+        void mapComponents(func_t&& func) {
+            for(auto& archetype : m_archetypes) {
+                if(archetype->getSize() == 0 || !archetype->hasTypes<comp_ts...>()) {
+                    continue;
+                }
+                for(std::size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+                    auto size = archetype->getChunkSize(chunk);
+                    [size, &func](comp_ts* const... columns) {
+                        for(std::size_t i = 0; i < size; i++) {
+                            func(columns[i]...);
+                        }
+                    }(archetype->template getColumnData<comp_ts>(chunk)...);
+                }
+            }
+        }
+
+    private:
+        struct EntityLocation {
+            Archetype* archetype;
+            std::size_t row;
+            emerald_entity entity;
+        };
+
+        EntityLocation& getLocation(const emerald_entity id) {
+            if(isEntityValid(id)) {
+                return m_locations[entityIndex(id)];
+            } else {
+                throw BadID("ArchetypeManager invalid entity id");
+            }
+        }
+
+        Archetype* findArchetype(std::vector<const ComponentInfo*> infos) {
+            std::vector<emerald_id> key;
+            for(auto info : infos) {
+                key.push_back(info->id);
+            }
+            std::sort(key.begin(), key.end());
+            if(auto iter = m_archetypeIndex.find(key); iter != m_archetypeIndex.end()) {
+                return iter->second;
+            }
+            m_archetypes.push_back(std::make_unique<Archetype>(std::move(infos), m_chunkBytes));
+            m_archetypeIndex[key] = m_archetypes.back().get();
+            return m_archetypes.back().get();
+        }
+
+        // Moves every shared component of id into newRow, which was allocated in target for it. Any other
+        // component in target has to be constructed already
+        void moveEntity(const emerald_entity id, Archetype* target, const std::size_t newRow) {
+            auto [source, row, entity] = m_locations[entityIndex(id)];
+            auto& infos = source->getComponentInfos();
+            for(std::size_t col = 0; col < infos.size(); col++) {
+                if(auto targetCol = target->getColumn(infos[col]->id); targetCol != Archetype::invalid_column) {
+                    infos[col]->move(target->get(targetCol, newRow), source->get(col, row));
+                }
+                infos[col]->destroy(source->get(col, row));
+            }
+            if(auto moved = source->removeRow(row); moved != invalid_entity) {
+                m_locations[entityIndex(moved)].row = row;
+            }
+            m_locations[entityIndex(id)] = {target, newRow, id};
+        }
+
+        std::size_t m_chunkBytes;
+        std::size_t m_entityCount;
+        Archetype* m_emptyArchetype;
+        std::vector<EntityLocation> m_locations;
+        std::vector<emerald_id> m_freeEntities;
+        std::vector<std::unique_ptr<Archetype>> m_archetypes;
+        std::map<std::vector<emerald_id>, Archetype*> m_archetypeIndex;
+    };
+
+};
+
+#endif // _EMERALD_ARCHETYPE_H
@@ -0,0 +1,174 @@
+#ifndef _EMERALD_COMMAND_BUFFER_H
+#define _EMERALD_COMMAND_BUFFER_H
+
+#include <vector>
+#include <memory>
+#include <optional>
+#include <numeric>
+#include <algorithm>
+#include "Util/types.hh"
+#include "Util/exceptions.hh"
+#include "Util/profiler.hh"
+#include "component.hh"
+
+namespace Emerald {
+
+    // Handles returned by CommandBuffer::createEntity use the highest generation, which real entities skip
+    static constexpr emerald_entity placeholder_generation = entity_generation_mask;
+
+    constexpr bool isPlaceholder(const emerald_entity entity) {
+        return entity != invalid_entity && entityGeneration(entity) == placeholder_generation;
+    }
+
+    // Records structural changes so they can be made outside of iteration. Flushing applies them in
+    // phases: entities are created, then components added and removed a type at a time in entity
+    // order, then entities removed. Adds and removes of the same type for the same entity keep the
+    // order they were recorded in. Like EntityManager::createComponent, adding a component the entity
+    // already has keeps the old one, record a remove first to replace it. Commands for entities that
+    // are gone by then are dropped
+    template<typename manager_t>
+    class CommandBuffer {
+    public:
+        CommandBuffer() = default;
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        // The handle is only a placeholder until the buffer is flushed and only means something to this buffer
+        emerald_entity createEntity() {
+            if(m_createCount >= entity_index_mask) {
+                throw BadID("CommandBuffer::createEntity placeholder limit reached");
+            }
+            EMERALD_PROFILE_CHANGES(1);
+            return makeEntity(m_createCount++, placeholder_generation);
+        }
+
+        template<typename comp_t, typename... args_t>
+        void createComponent(const emerald_entity id, args_t&&... args) {
+            EMERALD_PROFILE_CHANGES(1);
+            auto& batch = getBatch<comp_t>();
+            batch.commands.push_back({id, std::optional<comp_t>(std::in_place, std::forward<args_t>(args)...)});
+            batch.addCount++;
+        }
+
+        template<typename comp_t>
+        void removeComponent(const emerald_entity id) {
+            EMERALD_PROFILE_CHANGES(1);
+            getBatch<comp_t>().commands.push_back({id, std::nullopt});
+        }
+
+        void removeEntity(const emerald_entity id) {
+            EMERALD_PROFILE_CHANGES(1);
+            m_removedEntities.push_back(id);
+        }
+
+        bool isEmpty() const {
+            return m_createCount == 0 && m_removedEntities.size() == 0 && std::all_of(m_batches.begin(), m_batches.end(), [](auto& batch) {
+                return !batch || batch->isEmpty();
+            });
+        }
+
+        void flush(manager_t& entMan) {
+            m_created = entMan.createEntities(m_createCount);
+            for(auto& batch : m_batches) {
+                if(batch) {
+                    batch->apply(entMan, *this);
+                }
+            }
+            for(auto& id : m_removedEntities) {
+                id = resolve(id);
+            }
+            sortByIndex(m_removedEntities);
+            for(auto id : m_removedEntities) {
+                entMan.removeEntity(id);
+            }
+            m_removedEntities.clear();
+            m_created.clear();
+            m_createCount = 0;
+        }
+
+    private:
+        class IBaseBatch {
+        public:
+            virtual ~IBaseBatch() = default;
+            virtual bool isEmpty() const = 0;
+            virtual void apply(manager_t& entMan, CommandBuffer& buffer) = 0;
+        };
+
+        template<typename comp_t>
+        class Batch : public IBaseBatch {
+        public:
+            bool isEmpty() const override {
+                return commands.size() == 0;
+            }
+
+            // Commands are applied in entity order after reserving room for every added component at once,
+            // the components themselves are only moved once
+            void apply(manager_t& entMan, CommandBuffer& buffer) override {
+                if(commands.size() == 0) {
+                    return;
+                }
+                order.resize(commands.size());
+                std::iota(order.begin(), order.end(), 0);
+                for(auto& command : commands) {
+                    command.id = buffer.resolve(command.id);
+                }
+                std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+                    return entityIndex(commands[a].id) < entityIndex(commands[b].id);
+                });
+                entMan.template reserve<comp_t>(addCount);
+                for(auto i : order) {
+                    if(!commands[i].component) {
+                        entMan.template removeComponent<comp_t>(commands[i].id);
+                    } else if(entMan.isEntityValid(commands[i].id)) {
+                        entMan.template createComponent<comp_t>(commands[i].id, std::move(*commands[i].component));
+                    }
+                }
+                commands.clear();
+                addCount = 0;
+            }
+
+            // Removes have no component
+            struct Command {
+                emerald_entity id;
+                std::optional<comp_t> component;
+            };
+
+            std::vector<Command> commands;
+            std::size_t addCount = 0;
+            std::vector<std::size_t> order;
+        };
+
+        template<typename comp_t>
+        Batch<comp_t>& getBatch() {
+            auto compID = getComponentID<comp_t>();
+            if(compID >= m_batches.size()) {
+                m_batches.resize(compID + 1);
+            }
+            if(!m_batches[compID]) {
+                m_batches[compID] = std::make_unique<Batch<comp_t>>();
+            }
+            return static_cast<Batch<comp_t>&>(*m_batches[compID]);
+        }
+
+        emerald_entity resolve(const emerald_entity id) const {
+            if(isPlaceholder(id)) {
+                return entityIndex(id) < m_created.size() ? m_created[entityIndex(id)] : invalid_entity;
+            }
+            return id;
+        }
+
+        static void sortByIndex(std::vector<emerald_entity>& ids) {
+            std::sort(ids.begin(), ids.end(), [](emerald_entity a, emerald_entity b) {
+                return entityIndex(a) < entityIndex(b);
+            });
+        }
+
+        emerald_id m_createCount = 0;
+        std::vector<emerald_entity> m_created;
+        std::vector<emerald_entity> m_removedEntities;
+        std::vector<std::unique_ptr<IBaseBatch>> m_batches;
+    };
+
+};
+
+#endif // _EMERALD_COMMAND_BUFFER_H
@@ -2,42 +2,134 @@
 #define _EMERALD_COMPONENT_H
 
 #include <functional>
-#include <stack>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <type_traits>
+#include <algorithm>
+#include <new>
+#include <utility>
 #include "Util/types.hh"
 #include "Util/exceptions.hh"
+#include "Util/parallel.hh"
+#include "Util/bitset.hh"
+#include "Util/signature.hh"
+#include "Util/serialize.hh"
+#include "Util/profiler.hh"
 
 namespace Emerald {
 
-    class IBaseComponent {
-    public:
-        IBaseComponent(emerald_id entID)
-        : m_entityID(entID)
-        , m_enabled(true) {}
+    enum class PoolLayout {
+        // Deleted slots are reused by later components, a component never changes location
+        Stable,
+        // The last component is moved into every deleted slot, so the pool never has holes
+        Packed
+    };
 
-        IBaseComponent(IBaseComponent&& comp) {
-            m_entityID = comp.m_entityID;
-            m_enabled = comp.m_enabled;
-        }
+    // Empty components are tags, having one is nothing but a bit in the entity's signature
+    template<typename comp_t>
+    inline constexpr bool is_tag_v = std::is_empty_v<comp_t>;
 
-        virtual ~IBaseComponent() {
-            m_entityID = invalid_id;
-            m_enabled = false;
-        };
+    // Specialize for a component type to change how its pool is laid out
+    template<typename comp_t>
+    struct PoolTraits {
+        static constexpr PoolLayout layout = PoolLayout::Stable;
+    };
+
+    // Packed pools never hold a disabled component below their top, so there's nothing to check
+    template<typename comp_t>
+    inline constexpr bool is_packed_v = PoolTraits<comp_t>::layout == PoolLayout::Packed;
+
+    constexpr std::size_t floorPow2(const std::size_t value) {
+        return value < 2 ? 1 : floorPow2(value / 2) * 2;
+    }
+
+    constexpr std::size_t log2(const std::size_t value) {
+        return value < 2 ? 0 : log2(value / 2) + 1;
+    }
 
-        bool isEnabled() const {
-            return m_enabled;
+    static constexpr std::size_t default_page_bytes = 16384;
+
+    // Components per pool page, a power of two filling about default_page_bytes unless PoolTraits has a page_size
+    template<typename comp_t, typename = void>
+    struct PoolPageSize {
+        static constexpr std::size_t value = floorPow2(std::max<std::size_t>(default_page_bytes / sizeof(comp_t), 1));
+    };
+
+    template<typename comp_t>
+    struct PoolPageSize<comp_t, std::void_t<decltype(PoolTraits<comp_t>::page_size)>> {
+        static constexpr std::size_t value = PoolTraits<comp_t>::page_size;
+        static_assert(value > 0 && floorPow2(value) == value, "PoolTraits::page_size must be a power of two");
+    };
+
+    template<typename comp_t>
+    inline constexpr std::size_t pool_page_size_v = PoolPageSize<comp_t>::value;
+
+    template<typename comp_t>
+    inline constexpr std::size_t pool_page_shift_v = log2(pool_page_size_v<comp_t>);
+
+    // Set track_changes in PoolTraits to give every slot a version, writes stamp it with the current tick
+    template<typename comp_t, typename = void>
+    struct PoolTracksChanges : std::false_type {};
+
+    template<typename comp_t>
+    struct PoolTracksChanges<comp_t, std::void_t<decltype(PoolTraits<comp_t>::track_changes)>> : std::bool_constant<PoolTraits<comp_t>::track_changes> {};
+
+    template<typename comp_t>
+    inline constexpr bool tracks_changes_v = PoolTracksChanges<comp_t>::value;
+
+    // A tracked pool's version pages and the tick its mutable views stamp slots with, no pages when they don't
+    struct VersionStamp {
+        emerald_tick* const* pages = nullptr;
+        emerald_tick tick = 0;
+    };
+
+    template<typename comp_t, typename elem_t>
+    inline elem_t& slotAt(elem_t* const* pages, const std::size_t slot) {
+        return pages[slot >> pool_page_shift_v<comp_t>][slot & (pool_page_size_v<comp_t> - 1)];
+    }
+
+    // Every slot below a packed pool's top is live, stable pools track theirs in an occupancy bitset
+    template<typename comp_t>
+    inline std::size_t nextLiveSlot(const Bitset::word_t* occupied, const std::size_t slot, const std::size_t end) {
+        if constexpr(is_packed_v<comp_t>) {
+            return slot;
+        } else {
+            return Bitset::findNext(occupied, slot, end);
+        }
+    }
+
+    template<typename comp_t>
+    inline bool isSlotLive(const Bitset::word_t* occupied, const std::size_t slot) {
+        if constexpr(is_packed_v<comp_t>) {
+            return true;
+        } else {
+            return (occupied[slot / Bitset::word_bits] >> (slot % Bitset::word_bits)) & 1;
         }
+    }
 
-        emerald_id getEntityID() const {
-            return m_entityID;
+    // Calls func on every live slot in [begin, end), a page at a time
+    template<typename comp_t, typename elem_t, typename func_t>
+    inline void forEachSlot(elem_t* const* pages, const Bitset::word_t* occupied, std::size_t begin, const std::size_t end, func_t&& func) {
+        constexpr auto shift = pool_page_shift_v<comp_t>;
+        for(auto i = nextLiveSlot<comp_t>(occupied, begin, end); i < end; i = nextLiveSlot<comp_t>(occupied, i, end)) {
+            auto page = pages[i >> shift];
+            auto pageEnd = std::min(end, ((i >> shift) + 1) << shift);
+            for(; i < pageEnd; i = nextLiveSlot<comp_t>(occupied, i + 1, pageEnd)) {
+                func(page[i & (pool_page_size_v<comp_t> - 1)]);
+            }
         }
+    }
 
+    class IBaseComponent {
     protected:
         inline static emerald_id componentIDCounter = 0;
-        emerald_id m_entityID;
-        bool m_enabled;
     };
 
     template<typename comp_t>
@@ -47,63 +139,83 @@ namespace Emerald {
             static emerald_id componentID = componentIDCounter++;
             return componentID;
         }
+    };
 
-        template<typename... args_t>
-        Component(int id, args_t&&... args)
-        : IBaseComponent(id)
-        , m_component(std::forward<args_t>(args)...) {}
-
-        Component(Component<comp_t>&& comp)
-        : IBaseComponent(std::move(comp))
-        , m_component(std::move(comp.m_component)) {}
+    // What the system update running on this thread declared it writes, nullptr when everything counts as
+    // written: outside of updates and in systems that don't declare their access
+    inline const std::vector<emerald_id>*& currentSystemWrites() {
+        thread_local const std::vector<emerald_id>* writes = nullptr;
+        return writes;
+    }
 
-        comp_t& getComponent() {
-            if(m_enabled) {
-                return m_component;
-            } else {
-                throw std::logic_error("component is disabled");
-            }
-        };
+    // Mutable views only stamp the components the running system declared it writes, so systems that only read
+    // a tracked pool leave its versions alone and can share it
+    template<typename comp_t>
+    inline bool stampsWrites() {
+        auto writes = currentSystemWrites();
+        return writes == nullptr || std::find(writes->begin(), writes->end(), Component<comp_t>::getComponentID()) != writes->end();
+    }
 
-        const comp_t& getComponent() const {
-            if(m_enabled) {
-                return m_component;
-            } else {
-                throw std::logic_error("component is disabled");
-            }
+    // Makes writes what the thread's system declared it writes until the end of the scope
+    class SystemWritesScope {
+    public:
+        SystemWritesScope(const std::vector<emerald_id>* writes)
+        : m_previous(currentSystemWrites()) {
+            currentSystemWrites() = writes;
         }
 
-        comp_t& operator*() {
-            return getComponent();
+        ~SystemWritesScope() {
+            currentSystemWrites() = m_previous;
         }
 
-        const comp_t& operator*() const {
-            return getComponent();
+        SystemWritesScope(const SystemWritesScope&) = delete;
+        SystemWritesScope& operator=(const SystemWritesScope&) = delete;
+
+    private:
+        const std::vector<emerald_id>* m_previous;
+    };
+
+    class ISingleton {
+    public:
+        virtual ~ISingleton() = default;
+
+    protected:
+        inline static emerald_id singletonIDCounter = 0;
+    };
+
+    // A manager's one instance of value_t, stored on its own instead of in a pool
+    template<typename value_t>
+    class Singleton : public ISingleton {
+    public:
+        static emerald_id getSingletonID() {
+            static emerald_id singletonID = singletonIDCounter++;
+            return singletonID;
         }
 
-        comp_t* operator->() {
-            return &(getComponent());
+        template<typename... args_t>
+        Singleton(args_t&&... args)
+        : m_value(std::forward<args_t>(args)...) {}
+
+        value_t& get() {
+            return m_value;
         }
 
-        const comp_t* operator->() const {
-            return &(getComponent());
+        const value_t& get() const {
+            return m_value;
         }
 
-    protected:
-        comp_t m_component;
+    private:
+        value_t m_value;
     };
 
     template<typename comp_t>
     class ConstPoolViewIter {
     public:
-        ConstPoolViewIter(const Component<comp_t>* const view, const emerald_id loc, const emerald_id end)
-        : m_view(view)
-        , m_loc(loc)
-        , m_end(end) {
-            while(m_loc != m_end && m_view[m_loc].isEnabled() == false) {
-                m_loc++;
-            }
-        }
+        ConstPoolViewIter(const comp_t* const* const pages, const Bitset::word_t* const occupied, const emerald_id loc, const emerald_id end)
+        : m_pages(pages)
+        , m_occupied(occupied)
+        , m_loc(nextLiveSlot<comp_t>(occupied, loc, end))
+        , m_end(end) {}
 
         bool operator==(const ConstPoolViewIter<comp_t>& other) const {
             return m_loc == other.m_loc;
@@ -114,9 +226,7 @@ namespace Emerald {
         }
 
         ConstPoolViewIter& operator++() {
-            do {
-                m_loc++;
-            } while(m_loc != m_end && m_view[m_loc].isEnabled() == false);
+            m_loc = nextLiveSlot<comp_t>(m_occupied, m_loc + 1, m_end);
             return *this;
         }
 
@@ -127,15 +237,16 @@ namespace Emerald {
         }
 
         const comp_t* operator->() const {
-            return &(m_view[m_loc].getComponent());
+            return &slotAt<comp_t>(m_pages, m_loc);
         }
 
         const comp_t& operator*() const {
-            return m_view[m_loc].getComponent();
+            return slotAt<comp_t>(m_pages, m_loc);
         }
 
     private:
-        const Component<comp_t>* const m_view;
+        const comp_t* const* const m_pages;
+        const Bitset::word_t* const m_occupied;
         emerald_id m_loc;
         const emerald_id m_end;
     };
@@ -143,16 +254,17 @@ namespace Emerald {
     template<typename comp_t>
     class ConstPoolView {
     public:
-        ConstPoolView(const Component<comp_t>* const view, const std::size_t size) noexcept
-        : m_view(view)
+        ConstPoolView(const comp_t* const* const pages, const Bitset::word_t* const occupied, const std::size_t size) noexcept
+        : m_pages(pages)
+        , m_occupied(occupied)
         , m_size(size) {}
 
         ConstPoolViewIter<comp_t> begin() const {
-            return ConstPoolViewIter<comp_t>(m_view, 0, m_size);
+            return ConstPoolViewIter<comp_t>(m_pages, m_occupied, 0, m_size);
         }
 
         ConstPoolViewIter<comp_t> end() const {
-            return ConstPoolViewIter<comp_t>(m_view, m_size, m_size);
+            return ConstPoolViewIter<comp_t>(m_pages, m_occupied, m_size, m_size);
         }
 
         std::size_t getSize() const {
@@ -160,41 +272,57 @@ namespace Emerald {
         }
 
         bool contains(emerald_id id) const {
-            return id < m_size || !m_view[id].isEnabled();
+            return id < m_size && isSlotLive<comp_t>(m_occupied, id);
         }
 
         const comp_t& operator[](emerald_id id) const {
-            if(m_view[id].isEnabled() && id < m_size) {
-                return m_view[id].getComponent();
+            if(contains(id)) {
+                return slotAt<comp_t>(m_pages, id);
             } else {
                 throw BadID("PoolView::operator[] invalid id");
             }
         }
 
-        void map(std::function<void(const comp_t&)> func) const {
-            for(std::size_t i = 0; i < m_size; i++) {
-                if(m_view[i].isEnabled()) {
-                    func(m_view[i].getComponent());
-                }
-            }
+        template<typename func_t>
+        void map(func_t func) const {
+            EMERALD_PROFILE_VISITS(m_size);
+            forEachSlot<comp_t>(m_pages, m_occupied, 0, m_size, func);
+        }
+
+        template<typename func_t>
+        void parallelMap(ThreadPool* pool, func_t func, const std::size_t grain = default_grain) const {
+            EMERALD_PROFILE_VISITS(m_size);
+            parallelFor(pool, m_size, alignGrain<comp_t>(grain), [this, &func](std::size_t begin, std::size_t end, std::size_t) {
+                forEachSlot<comp_t>(m_pages, m_occupied, begin, end, func);
+            });
+        }
+
+        template<typename local_t, typename func_t>
+        void parallelMap(ThreadPool* pool, PerThread<local_t>& locals, func_t func, const std::size_t grain = default_grain) const {
+            EMERALD_PROFILE_VISITS(m_size);
+            parallelFor(pool, m_size, alignGrain<comp_t>(grain), [this, &locals, &func](std::size_t begin, std::size_t end, std::size_t worker) {
+                auto& local = locals[worker];
+                forEachSlot<comp_t>(m_pages, m_occupied, begin, end, [&func, &local](auto& comp) {
+                    func(comp, local);
+                });
+            });
         }
 
     private:
-        const Component<comp_t>* const m_view;
+        const comp_t* const* const m_pages;
+        const Bitset::word_t* const m_occupied;
         const std::size_t m_size;
     };
 
     template<typename comp_t>
     class PoolViewIter {
     public:
-        PoolViewIter(Component<comp_t>* const view, const emerald_id loc, const emerald_id end)
-        : m_view(view)
-        , m_loc(loc)
-        , m_end(end) {
-            while(m_loc != m_end && m_view[m_loc].isEnabled() == false) {
-                m_loc++;
-            }
-        }
+        PoolViewIter(comp_t* const* const pages, const Bitset::word_t* const occupied, const emerald_id loc, const emerald_id end, const VersionStamp stamp = {})
+        : m_pages(pages)
+        , m_occupied(occupied)
+        , m_loc(nextLiveSlot<comp_t>(occupied, loc, end))
+        , m_end(end)
+        , m_stamp(stamp) {}
 
         bool operator==(const PoolViewIter<comp_t>& other) const {
             return m_loc == other.m_loc;
@@ -205,9 +333,7 @@ namespace Emerald {
         }
 
         PoolViewIter& operator++() {
-            do {
-                m_loc++;
-            } while(m_loc != m_end && m_view[m_loc].isEnabled() == false);
+            m_loc = nextLiveSlot<comp_t>(m_occupied, m_loc + 1, m_end);
             return *this;
         }
 
@@ -218,48 +344,55 @@ namespace Emerald {
         }
 
         comp_t* operator->() {
-            return &(m_view[m_loc].getComponent());
+            return &operator*();
         }
 
         const comp_t* operator->() const {
-            return &(m_view[m_loc].getComponent());
+            return &slotAt<comp_t>(m_pages, m_loc);
         }
 
         comp_t& operator*() {
-            return m_view[m_loc].getComponent();
+            if(tracks_changes_v<comp_t> && m_stamp.pages != nullptr) {
+                slotAt<comp_t>(m_stamp.pages, m_loc) = m_stamp.tick;
+            }
+            return slotAt<comp_t>(m_pages, m_loc);
         }
 
         const comp_t& operator*() const {
-            return m_view[m_loc].getComponent();
+            return slotAt<comp_t>(m_pages, m_loc);
         }
 
     private:
-        Component<comp_t>* const m_view;
+        comp_t* const* const m_pages;
+        const Bitset::word_t* const m_occupied;
         emerald_id m_loc;
         const emerald_id m_end;
+        const VersionStamp m_stamp;
     };
 
     template<typename comp_t>
     class PoolView {
     public:
-        PoolView(Component<comp_t>* const view, const std::size_t size) noexcept
-        : m_view(view)
-        , m_size(size) {}
+        PoolView(comp_t* const* const pages, const Bitset::word_t* const occupied, const std::size_t size, const VersionStamp stamp = {}) noexcept
+        : m_pages(pages)
+        , m_occupied(occupied)
+        , m_size(size)
+        , m_stamp(stamp) {}
 
         PoolViewIter<comp_t> begin() {
-            return PoolViewIter<comp_t>(m_view, 0, m_size);
+            return PoolViewIter<comp_t>(m_pages, m_occupied, 0, m_size, m_stamp);
         }
 
         PoolViewIter<comp_t> end() {
-            return PoolViewIter<comp_t>(m_view, m_size, m_size);
+            return PoolViewIter<comp_t>(m_pages, m_occupied, m_size, m_size, m_stamp);
         }
 
         ConstPoolViewIter<comp_t> begin() const {
-            return ConstPoolViewIter<comp_t>(m_view, 0, m_size);
+            return ConstPoolViewIter<comp_t>(m_pages, m_occupied, 0, m_size);
         }
 
         ConstPoolViewIter<comp_t> end() const {
-            return ConstPoolViewIter<comp_t>(m_view, m_size, m_size);
+            return ConstPoolViewIter<comp_t>(m_pages, m_occupied, m_size, m_size);
         }
 
         std::size_t getSize() const {
@@ -267,133 +400,1293 @@ namespace Emerald {
         }
 
         bool contains(emerald_id id) const {
-            return id < m_size || !m_view[id].isEnabled();
+            return id < m_size && isSlotLive<comp_t>(m_occupied, id);
         }
 
         comp_t& operator[](emerald_id id) {
-            if(m_view[id].isEnabled() && id < m_size) {
-                return m_view[id].getComponent();
+            if(contains(id)) {
+                if(tracks_changes_v<comp_t> && m_stamp.pages != nullptr) {
+                    slotAt<comp_t>(m_stamp.pages, id) = m_stamp.tick;
+                }
+                return slotAt<comp_t>(m_pages, id);
             } else {
                 throw BadID("PoolView::operator[] invalid id");
             }
         }
 
         const comp_t& operator[](emerald_id id) const {
-            if(m_view[id].isEnabled() && id < m_size) {
-                return m_view[id].getComponent();
+            if(contains(id)) {
+                return slotAt<comp_t>(m_pages, id);
             } else {
                 throw BadID("PoolView::operator[] invalid id");
             }
         }
 
-        void map(std::function<void(comp_t&)> func) {
-            for(std::size_t i = 0; i < m_size; i++) {
-                if(m_view[i].isEnabled()) {
-                    func(m_view[i].getComponent());
-                }
-            }
+        template<typename func_t>
+        void map(func_t func) {
+            EMERALD_PROFILE_VISITS(m_size);
+            stamp(0, m_size);
+            forEachSlot<comp_t>(m_pages, m_occupied, 0, m_size, func);
         }
 
-        void map(std::function<void(const comp_t&)> func) const {
-            for(std::size_t i = 0; i < m_size; i++) {
-                if(m_view[i].isEnabled()) {
-                    func(m_view[i].getComponent());
-                }
-            }
+        template<typename func_t>
+        void map(func_t func) const {
+            EMERALD_PROFILE_VISITS(m_size);
+            forEachSlot<comp_t>(m_pages, m_occupied, 0, m_size, func);
+        }
+
+        // Splits the pool into cache line aligned chunks of at least grain components and maps them on pool's threads
+        template<typename func_t>
+        void parallelMap(ThreadPool* pool, func_t func, const std::size_t grain = default_grain) {
+            EMERALD_PROFILE_VISITS(m_size);
+            parallelFor(pool, m_size, alignGrain<comp_t>(grain), [this, &func](std::size_t begin, std::size_t end, std::size_t) {
+                stamp(begin, end);
+                forEachSlot<comp_t>(m_pages, m_occupied, begin, end, func);
+            });
+        }
+
+        // Like parallelMap but func also gets the calling thread's slot in locals, to reduce into without locking
+        template<typename local_t, typename func_t>
+        void parallelMap(ThreadPool* pool, PerThread<local_t>& locals, func_t func, const std::size_t grain = default_grain) {
+            EMERALD_PROFILE_VISITS(m_size);
+            parallelFor(pool, m_size, alignGrain<comp_t>(grain), [this, &locals, &func](std::size_t begin, std::size_t end, std::size_t worker) {
+                auto& local = locals[worker];
+                stamp(begin, end);
+                forEachSlot<comp_t>(m_pages, m_occupied, begin, end, [&func, &local](auto& comp) {
+                    func(comp, local);
+                });
+            });
         }
 
     private:
-        Component<comp_t>* const m_view;
+        // Everything mapped mutably counts as changed
+        void stamp(const std::size_t begin, const std::size_t end) {
+            if(tracks_changes_v<comp_t> && m_stamp.pages != nullptr) {
+                forEachSlot<comp_t>(m_stamp.pages, m_occupied, begin, end, [tick = m_stamp.tick](emerald_tick& version) {
+                    version = tick;
+                });
+            }
+        }
+
+        comp_t* const* const m_pages;
+        const Bitset::word_t* const m_occupied;
         const std::size_t m_size;
+        const VersionStamp m_stamp;
+    };
+
+    // Tombstones are the holes a stable pool leaves when components are removed, bytes counts everything the
+    // pool has allocated
+    struct PoolStats {
+        std::size_t live = 0;
+        std::size_t capacity = 0;
+        std::size_t tombstones = 0;
+        std::size_t bytes = 0;
+
+        PoolStats& operator+=(const PoolStats& other) {
+            live += other.live;
+            capacity += other.capacity;
+            tombstones += other.tombstones;
+            bytes += other.bytes;
+            return *this;
+        }
     };
 
     class IBaseComponentPool {
     public:
         virtual ~IBaseComponentPool() = default;
         virtual void deleteComponent(const emerald_id location) = 0;
+        virtual void removeComponent(const emerald_entity entID) = 0;
+        virtual bool hasComponent(const emerald_entity entID) const = 0;
+        virtual void flushEvents() = 0;
+        virtual void clear() = 0;
+        virtual PoolStats getStats() const = 0;
+        virtual bool compact(const std::size_t maxMoves) = 0;
+        virtual void shrinkToFit() = 0;
     };
 
-    template<typename comp_t>
+    // Owning groups and system memberships are told after a component of a type they follow is added and
+    // before one is removed
+    class IBaseGroup {
+    public:
+        virtual ~IBaseGroup() = default;
+        virtual void onCreate(const emerald_entity entID) = 0;
+        virtual void onDelete(const emerald_entity entID) = 0;
+        virtual void rebuild() = 0;
+
+    protected:
+        inline static emerald_id groupIDCounter = 0;
+    };
+
+    // Observers get every entity of an event at once
+    typedef std::function<void(const std::vector<emerald_entity>&)> pool_observer_t;
+
+    // Stores components in fixed size pages with nothing but the component in each slot, which entity owns a
+    // slot and whether a stable pool's slot is in use are kept alongside. Growing adds a page, so components
+    // never move unless a packed pool fills a hole with its last one. Tags get the specialization below instead
+    template<typename comp_t, typename = void>
     class ComponentPool : public IBaseComponentPool {
     public:
-        ComponentPool(const std::size_t amount = 10)
-        : m_poolBasePtr(reinterpret_cast<Component<comp_t>*>(malloc(sizeof(Component<comp_t>) * amount)))
+        static constexpr bool is_packed = is_packed_v<comp_t>;
+        static constexpr std::size_t page_size = pool_page_size_v<comp_t>;
+
+        // Everything the pool allocates comes from resource
+        ComponentPool(std::pmr::memory_resource* resource = std::pmr::get_default_resource(), const std::size_t amount = 10)
+        : m_resource(resource)
+        , m_pages(resource)
         , m_poolTop(0)
-        , m_poolSize(amount) {
+        , m_freeLocations(resource)
+        , m_occupied(resource)
+        , m_sparse(resource)
+        , m_dense(resource)
+        , m_versions(resource)
+        , m_removals(resource) {
             static_assert(std::is_nothrow_move_constructible<comp_t>::value, "Component must be no-throw move construcible");
+            while(m_pages.size() * page_size < amount) {
+                addPage();
+            }
         };
 
+        ComponentPool(const ComponentPool&) = delete;
+        ComponentPool& operator=(const ComponentPool&) = delete;
+
         ~ComponentPool() {
-            if(m_poolBasePtr != nullptr) {
-                for(Component<comp_t>* itr = m_poolBasePtr; itr < m_poolBasePtr + m_poolTop; itr++) {
-                    if(itr->isEnabled()) {
-                        itr->~IBaseComponent();
-                    }
+            for(emerald_id i = 0; i < m_poolTop; i++) {
+                if(isOccupied(i)) {
+                    slot(i).~comp_t();
+                }
+            }
+            while(m_pages.size() > 0) {
+                releasePage();
+            }
+            for(auto page : m_sparse) {
+                if(page != nullptr) {
+                    deallocateArray(page, sparse_page_size);
                 }
-                free(m_poolBasePtr);
             }
         }
 
         template<typename... args_t>
-        emerald_id createComponent(const emerald_id entID, args_t&&... args) {
+        emerald_id createComponent(const emerald_entity entID, args_t&&... args) {
             emerald_id location = 0;
             if(m_freeLocations.size() > 0) {
-                location = m_freeLocations.top();
-                m_freeLocations.pop();
-            } else if(m_poolTop >= m_poolSize) {
-                Component<comp_t>* newPtr = reinterpret_cast<Component<comp_t>*>(malloc(sizeof(Component<comp_t>) * m_poolSize * 2));
-                for(auto i = 0; i < m_poolSize; i++) {
-                    new(&newPtr[i]) Component<comp_t>(std::move(m_poolBasePtr[i]));
-                    m_poolBasePtr[i].~Component<comp_t>();
-                }
-                free(m_poolBasePtr);
-                m_poolBasePtr = newPtr;
-                m_poolSize *= 2;
-                return createComponent(entID, std::forward<args_t>(args)...);
+                location = m_freeLocations.back();
+                m_freeLocations.pop_back();
             } else {
+                if(m_poolTop >= m_pages.size() * page_size) {
+                    addPage();
+                }
                 location = m_poolTop;
                 m_poolTop++;
             }
-            new(m_poolBasePtr + location) Component<comp_t>(entID, std::forward<args_t>(args)...);
+            new(&slot(location)) comp_t(std::forward<args_t>(args)...);
+            if constexpr(!is_packed) {
+                m_occupied.set(location);
+            }
+            markChanged(location);
+            sparseAt(entityIndex(entID)) = location;
+            denseAt(location) = entID;
+            if(m_signatures != nullptr) {
+                (*m_signatures)[entityIndex(entID)].set(m_signatureBit);
+            }
+            if(m_onAdd.size() > 0) {
+                m_added.push_back(entID);
+            }
+            for(auto watcher : m_watchers) {
+                watcher->onCreate(entID);
+            }
+            if(m_group != nullptr) {
+                m_group->onCreate(entID);
+                return getLocation(entID);
+            }
             return location;
         }
 
-        void deleteComponent(const emerald_id location) {
-            if((m_poolBasePtr + location)->isEnabled()) {
-                (m_poolBasePtr + location)->~Component<comp_t>();
-                m_freeLocations.push(location);
+        void deleteComponent(emerald_id location) {
+            if(location < m_poolTop && isOccupied(location)) {
+                for(auto watcher : m_watchers) {
+                    watcher->onDelete(denseAt(location));
+                }
+                if(m_group != nullptr) {
+                    auto entID = denseAt(location);
+                    m_group->onDelete(entID);
+                    location = getLocation(entID);
+                }
+                if(m_onRemove.size() > 0) {
+                    m_removed.push_back(denseAt(location));
+                }
+                if constexpr(tracks_changes) {
+                    m_removals.emplace_back(denseAt(location), getTick());
+                }
+                if(m_signatures != nullptr) {
+                    (*m_signatures)[entityIndex(denseAt(location))].reset(m_signatureBit);
+                }
+                slot(location).~comp_t();
+                sparseAt(entityIndex(denseAt(location))) = invalid_id;
+                denseAt(location) = invalid_entity;
+                if constexpr(is_packed) {
+                    auto last = --m_poolTop;
+                    if(location != last) {
+                        moveSlot(last, location);
+                    }
+                } else {
+                    m_occupied.reset(location);
+                    m_freeSorted = m_freeSorted && (m_freeLocations.size() == 0 || m_freeLocations.back() < location);
+                    m_freeLocations.push_back(location);
+                }
+            }
+        }
+
+        // Adds pages until amount more components fit without growing, holes are filled first
+        void reserve(const std::size_t amount) {
+            auto needed = m_poolTop + amount - std::min(amount, m_freeLocations.size());
+            while(m_pages.size() * page_size < needed) {
+                addPage();
             }
         }
 
+        // Number of live components
+        std::size_t getSize() const {
+            return m_poolTop - m_freeLocations.size();
+        }
+
+        void removeComponent(const emerald_entity entID) {
+            if(auto location = getLocation(entID); location != invalid_id) {
+                deleteComponent(location);
+            }
+        }
+
+        // Returns invalid_id for stale handles, the location's owner has to match the whole handle
+        emerald_id getLocation(const emerald_entity entID) const {
+            if(auto index = entityIndex(entID); (index >> sparse_page_shift) < m_sparse.size() && m_sparse[index >> sparse_page_shift] != nullptr) {
+                if(auto location = m_sparse[index >> sparse_page_shift][index & (sparse_page_size - 1)]; location != invalid_id && denseAt(location) == entID) {
+                    return location;
+                }
+            }
+            return invalid_id;
+        }
+
+        bool hasComponent(const emerald_entity entID) const {
+            return getLocation(entID) != invalid_id;
+        }
+
+        emerald_entity getEntity(const emerald_id location) const {
+            return location < m_poolTop ? denseAt(location) : invalid_entity;
+        }
+
+        bool isOccupied(const emerald_id location) const {
+            if constexpr(is_packed) {
+                return location < m_poolTop;
+            } else {
+                return m_occupied.test(location);
+            }
+        }
+
+        // Every location in use is below this, holes included
+        std::size_t getTop() const {
+            return m_poolTop;
+        }
+
+        // Iterating the view or indexing it mutably stamps the slots it hands out when the pool tracks changes and
+        // the running system, if any, declared it writes them
         PoolView<comp_t> getComponentView() {
-            return PoolView<comp_t>(m_poolBasePtr, m_poolTop);
+            return PoolView<comp_t>(m_pages.data(), m_occupied.getWords(), m_poolTop, {stampsWrites<comp_t>() ? m_versions.data() : nullptr, getTick()});
         };
 
         ConstPoolView<comp_t> getComponentView() const {
-            return ConstPoolView<comp_t>(m_poolBasePtr, m_poolTop);
+            return ConstPoolView<comp_t>(m_pages.data(), m_occupied.getWords(), m_poolTop);
         }
 
         comp_t& getComponent(emerald_id id) {
-            if(id < m_poolSize && m_poolBasePtr[id].isEnabled()) {
-                return *(m_poolBasePtr[id]);
+            if(id < m_poolTop && isOccupied(id)) {
+                return getSlot(id);
             } else {
                 throw std::runtime_error("getComponent() invalid id");
             }
         }
 
         const comp_t& getComponent(emerald_id id) const {
-            if(id < m_poolSize && m_poolBasePtr[id].isEnabled()) {
-                return *(m_poolBasePtr[id]);
+            if(id < m_poolTop && isOccupied(id)) {
+                return getSlot(id);
             } else {
                 throw std::runtime_error("getComponent() invalid id");
             }
         }
 
+        // Unchecked access for locations that are already known to be live. Only writeSlot stamps the slot,
+        // so readers sharing the pool across threads never write to it
+        comp_t& getSlot(const emerald_id location) {
+            return slot(location);
+        }
+
+        comp_t& writeSlot(const emerald_id location) {
+            markChanged(location);
+            return slot(location);
+        }
+
+        const comp_t& getSlot(const emerald_id location) const {
+            return slotAt<comp_t>(m_pages.data(), location);
+        }
+
+        // The tick location was last written at, or 0 when the pool doesn't track changes
+        emerald_tick getVersion(const emerald_id location) const {
+            if constexpr(tracks_changes) {
+                return slotAt<comp_t>(m_versions.data(), location);
+            } else {
+                return 0;
+            }
+        }
+
+        bool changedSince(const emerald_id location, const emerald_tick tick) const {
+            return getVersion(location) > tick;
+        }
+
+        // Stamps location with the current tick, for components changed through getComponent or getSlot
+        void markChanged(const emerald_id location) {
+            if constexpr(tracks_changes) {
+                slotAt<comp_t>(m_versions.data(), location) = getTick();
+            }
+        }
+
+        // Destroys every component, observers stay but their pending events are dropped
+        void clear() override {
+            for(emerald_id location = 0; location < m_poolTop; location++) {
+                if(isOccupied(location)) {
+                    // A snapshot being loaded might have shrunk the entity table already
+                    if(auto index = entityIndex(denseAt(location)); m_signatures != nullptr && index < m_signatures->size()) {
+                        (*m_signatures)[index].reset(m_signatureBit);
+                    }
+                    slot(location).~comp_t();
+                    sparseAt(entityIndex(denseAt(location))) = invalid_id;
+                    denseAt(location) = invalid_entity;
+                }
+            }
+            m_poolTop = 0;
+            m_freeLocations.clear();
+            m_freeSorted = true;
+            m_occupied.clear();
+            m_added.clear();
+            m_removed.clear();
+            m_removals.clear();
+            rebuildGroups();
+        }
+
+        // Writes the owner of every slot up to the top, which slots are in use and the components. Trivially
+        // copyable components are written a page at a time, anything else through its Serializer
+        void saveSnapshot(SnapshotWriter& writer) const {
+            static_assert(is_raw_serializable_v<comp_t> || has_serializer_v<comp_t>, "Component needs a Serializer to be saved");
+            writer.write<uint64_t>(sizeof(comp_t));
+            writer.write<uint32_t>(m_poolTop);
+            for(emerald_id begin = 0; begin < m_poolTop; begin += page_size) {
+                auto count = std::min<std::size_t>(page_size, m_poolTop - begin);
+                writer.write(m_dense[begin >> pool_page_shift_v<comp_t>], count * sizeof(emerald_entity));
+            }
+            writer.write<uint64_t>(m_occupied.getWordCount());
+            writer.write(m_occupied.getWords(), m_occupied.getWordCount() * sizeof(Bitset::word_t));
+            if constexpr(is_raw_serializable_v<comp_t>) {
+                for(emerald_id begin = 0; begin < m_poolTop; begin += page_size) {
+                    auto count = std::min<std::size_t>(page_size, m_poolTop - begin);
+                    writer.write(m_pages[begin >> pool_page_shift_v<comp_t>], count * sizeof(comp_t));
+                }
+            } else {
+                for(emerald_id location = 0; location < m_poolTop; location++) {
+                    if(isOccupied(location)) {
+                        Serializer<comp_t>::write(writer, getSlot(location));
+                    }
+                }
+            }
+        }
+
+        // Replaces the pool's components with the ones saved by saveSnapshot, raw columns are copied
+        // straight into the pages. Every owner has to be live in entities, the entity table loaded with the
+        // snapshot, and own one slot at most. Anything else throws BadSnapshot and leaves the pool empty
+        void loadSnapshot(SnapshotReader& reader, const std::pmr::vector<emerald_entity>& entities) {
+            static_assert(is_raw_serializable_v<comp_t> || has_serializer_v<comp_t>, "Component needs a Serializer to be loaded");
+            clear();
+            if(reader.read<uint64_t>() != sizeof(comp_t)) {
+                throw BadSnapshot("Snapshot component size doesn't match");
+            }
+            auto top = reader.read<uint32_t>();
+            if(top > reader.getRemaining() / sizeof(emerald_entity)) {
+                throw BadSnapshot("Snapshot is truncated");
+            }
+            reserve(top);
+            // Nothing is published until m_poolTop is set, so the slots stay invisible while they're filled in
+            auto live = [this](const emerald_id location) {
+                return is_packed || m_occupied.test(location);
+            };
+            emerald_id built = 0;
+            try {
+                for(emerald_id begin = 0; begin < top; begin += page_size) {
+                    auto count = std::min<std::size_t>(page_size, top - begin);
+                    reader.readInto(m_dense[begin >> pool_page_shift_v<comp_t>], count * sizeof(emerald_entity));
+                }
+                auto words = reader.read<uint64_t>();
+                if(words != (is_packed ? 0 : (std::size_t(top) + Bitset::word_bits - 1) / Bitset::word_bits)) {
+                    throw BadSnapshot("Snapshot occupancy doesn't match the pool size");
+                }
+                m_occupied.assign(reader.read(words * sizeof(Bitset::word_t)), words);
+                for(emerald_id location = 0; location < top; location++) {
+                    if(live(location)) {
+                        auto owner = denseAt(location);
+                        if(entityIndex(owner) >= entities.size() || entities[entityIndex(owner)] != owner || sparseAt(entityIndex(owner)) != invalid_id) {
+                            throw BadSnapshot("Snapshot component owner isn't a live entity");
+                        }
+                        sparseAt(entityIndex(owner)) = location;
+                    }
+                }
+                if constexpr(is_raw_serializable_v<comp_t>) {
+                    for(emerald_id begin = 0; begin < top; begin += page_size) {
+                        auto count = std::min<std::size_t>(page_size, top - begin);
+                        reader.readInto(m_pages[begin >> pool_page_shift_v<comp_t>], count * sizeof(comp_t));
+                    }
+                } else {
+                    for(; built < top; built++) {
+                        if(live(built)) {
+                            new(&slot(built)) comp_t(Serializer<comp_t>::read(reader));
+                        }
+                    }
+                }
+            } catch(...) {
+                for(emerald_id location = 0; location < top; location++) {
+                    if(live(location)) {
+                        if(location < built) {
+                            slot(location).~comp_t();
+                        }
+                        if(auto index = entityIndex(denseAt(location)); index < entities.size() && sparseAt(index) == location) {
+                            sparseAt(index) = invalid_id;
+                        }
+                    }
+                    denseAt(location) = invalid_entity;
+                }
+                m_occupied.clear();
+                throw;
+            }
+            m_poolTop = top;
+            for(emerald_id location = top; location-- > 0;) {
+                if(isOccupied(location)) {
+                    if(m_signatures != nullptr) {
+                        (*m_signatures)[entityIndex(denseAt(location))].set(m_signatureBit);
+                    }
+                    markChanged(location);
+                } else {
+                    denseAt(location) = invalid_entity;
+                    m_freeLocations.push_front(location);
+                }
+            }
+            rebuildGroups();
+        }
+
+        // Writes the entities that lost their component after tick since and every component stamped after it,
+        // which covers new ones
+        void saveDelta(SnapshotWriter& writer, const emerald_tick since) {
+            if constexpr(tracks_changes) {
+                static_assert(is_raw_serializable_v<comp_t> || has_serializer_v<comp_t>, "Component needs a Serializer to be saved");
+                writer.write<uint64_t>(sizeof(comp_t));
+                auto removed = std::partition_point(m_removals.begin(), m_removals.end(), [since](const auto& removal) {
+                    return removal.second <= since;
+                });
+                writer.write<uint64_t>(m_removals.end() - removed);
+                for(; removed != m_removals.end(); ++removed) {
+                    writer.write(removed->first);
+                }
+                uint64_t changed = 0;
+                for(emerald_id location = 0; location < m_poolTop; location++) {
+                    changed += isOccupied(location) && getVersion(location) > since;
+                }
+                writer.write(changed);
+                for(emerald_id location = 0; location < m_poolTop; location++) {
+                    if(isOccupied(location) && getVersion(location) > since) {
+                        writer.write(denseAt(location));
+                        if constexpr(is_raw_serializable_v<comp_t>) {
+                            writer.write(&getSlot(location), sizeof(comp_t));
+                        } else {
+                            Serializer<comp_t>::write(writer, getSlot(location));
+                        }
+                    }
+                }
+            }
+        }
+
+        // Removes the components saveDelta listed as removed, then overwrites or creates the changed ones.
+        // Everything applied is stamped and observers are told as usual. Components are only created for
+        // entities live in entities, anything else throws BadSnapshot
+        void loadDelta(SnapshotReader& reader, const std::pmr::vector<emerald_entity>& entities) {
+            auto live = [&entities](const emerald_entity entID) {
+                if(entityIndex(entID) >= entities.size() || entities[entityIndex(entID)] != entID) {
+                    throw BadSnapshot("Delta component owner isn't a live entity");
+                }
+            };
+            if constexpr(tracks_changes) {
+                static_assert(is_raw_serializable_v<comp_t> || has_serializer_v<comp_t>, "Component needs a Serializer to be loaded");
+                if(reader.read<uint64_t>() != sizeof(comp_t)) {
+                    throw BadSnapshot("Delta component size doesn't match");
+                }
+                for(auto removed = reader.read<uint64_t>(); removed > 0; removed--) {
+                    removeComponent(reader.read<emerald_entity>());
+                }
+                for(auto changed = reader.read<uint64_t>(); changed > 0; changed--) {
+                    auto entID = reader.read<emerald_entity>();
+                    auto location = getLocation(entID);
+                    if constexpr(is_raw_serializable_v<comp_t>) {
+                        if(location != invalid_id) {
+                            reader.readInto(&writeSlot(location), sizeof(comp_t));
+                        } else {
+                            live(entID);
+                            alignas(comp_t) unsigned char bytes[sizeof(comp_t)];
+                            reader.readInto(bytes, sizeof(comp_t));
+                            createComponent(entID, std::move(*std::launder(reinterpret_cast<comp_t*>(bytes))));
+                        }
+                    } else {
+                        auto component = Serializer<comp_t>::read(reader);
+                        if(location != invalid_id) {
+                            slot(location).~comp_t();
+                            new(&slot(location)) comp_t(std::move(component));
+                            markChanged(location);
+                        } else {
+                            live(entID);
+                            createComponent(entID, std::move(component));
+                        }
+                    }
+                }
+            }
+        }
+
+        // Removals are remembered for deltas until they're forgotten, deltas made since tick or later don't need
+        // the ones up to it
+        void forgetChanges(const emerald_tick tick) {
+            m_removals.erase(m_removals.begin(), std::partition_point(m_removals.begin(), m_removals.end(), [tick](const auto& removal) {
+                return removal.second <= tick;
+            }));
+        }
+
+        PoolStats getStats() const override {
+            PoolStats stats;
+            stats.live = getSize();
+            stats.capacity = m_pages.size() * page_size;
+            stats.tombstones = m_freeLocations.size();
+            stats.bytes = m_pages.size() * (page_bytes + page_size * sizeof(emerald_entity)) + m_versions.size() * page_size * sizeof(emerald_tick)
+                + m_pages.capacity() * sizeof(comp_t*) + m_dense.capacity() * sizeof(m_dense[0]) + m_versions.capacity() * sizeof(emerald_tick*)
+                + m_sparse.capacity() * sizeof(m_sparse[0]) + m_freeLocations.size() * sizeof(emerald_id) + m_occupied.getBytes();
+            for(auto& page : m_sparse) {
+                stats.bytes += page != nullptr ? sparse_page_size * sizeof(emerald_id) : 0;
+            }
+            return stats;
+        }
+
+        // Moves up to maxMoves of the last components into the lowest holes and frees the pages past the last
+        // component. Returns true once there are no holes left. Components that move keep their version, but
+        // their location changes, so nothing should hold a location, reference or view into the pool across it
+        bool compact(const std::size_t maxMoves) override {
+            if(!m_freeSorted) {
+                std::sort(m_freeLocations.begin(), m_freeLocations.end());
+                m_freeSorted = true;
+            }
+            trimTop();
+            for(std::size_t moves = 0; moves < maxMoves && m_freeLocations.size() > 0; moves++) {
+                auto hole = m_freeLocations.front();
+                m_freeLocations.pop_front();
+                m_occupied.set(hole);
+                m_occupied.reset(m_poolTop - 1);
+                moveSlot(m_poolTop - 1, hole);
+                trimTop();
+            }
+            while(m_pages.size() > (m_poolTop + page_size - 1) / page_size) {
+                releasePage();
+            }
+            return m_freeLocations.size() == 0;
+        }
+
+        // Compacts the pool completely and gives back every allocation it can, including the sparse pages of
+        // entity ranges that no longer have the component
+        void shrinkToFit() override {
+            compact(std::numeric_limits<std::size_t>::max());
+            for(auto& page : m_sparse) {
+                if(page != nullptr && std::all_of(page, page + sparse_page_size, [](emerald_id location) {
+                    return location == invalid_id;
+                })) {
+                    deallocateArray(page, sparse_page_size);
+                    page = nullptr;
+                }
+            }
+            while(m_sparse.size() > 0 && m_sparse.back() == nullptr) {
+                m_sparse.pop_back();
+            }
+            m_sparse.shrink_to_fit();
+            m_pages.shrink_to_fit();
+            m_dense.shrink_to_fit();
+            m_versions.shrink_to_fit();
+            m_freeLocations.shrink_to_fit();
+            m_occupied.truncate(m_poolTop);
+        }
+
+        // Orders the components by compare, which takes either two components or two entities. A stable pool
+        // is compacted first. A pool owned by a group is ordered by the group instead
+        template<typename compare_t>
+        void sort(compare_t compare) {
+            if(m_group != nullptr) {
+                throw BadComponent("Components owned by a group can only be sorted through the group");
+            }
+            compact(std::numeric_limits<std::size_t>::max());
+            reorder(sortedOrder(compare, m_poolTop));
+        }
+
+        // The locations of the first count components in the order compare puts them
+        template<typename compare_t>
+        std::vector<emerald_id> sortedOrder(compare_t& compare, const std::size_t count) const {
+            std::vector<emerald_id> order(count);
+            std::iota(order.begin(), order.end(), 0);
+            if constexpr(std::is_invocable_r<bool, compare_t&, const comp_t&, const comp_t&>::value) {
+                std::sort(order.begin(), order.end(), [this, &compare](emerald_id a, emerald_id b) {
+                    return compare(getSlot(a), getSlot(b));
+                });
+            } else {
+                std::sort(order.begin(), order.end(), [this, &compare](emerald_id a, emerald_id b) {
+                    return compare(denseAt(a), denseAt(b));
+                });
+            }
+            return order;
+        }
+
+        // Moves the component at order[i] to i, following each cycle of the permutation so every component
+        // moves once. order has to cover live locations only
+        void reorder(std::vector<emerald_id> order) {
+            for(emerald_id start = 0; start < order.size(); start++) {
+                if(order[start] == start) {
+                    continue;
+                }
+                comp_t held(std::move(slot(start)));
+                slot(start).~comp_t();
+                auto heldEntity = denseAt(start);
+                auto heldVersion = getVersion(start);
+                auto to = start;
+                while(order[to] != start) {
+                    auto from = order[to];
+                    moveSlot(from, to);
+                    order[to] = to;
+                    to = from;
+                }
+                placeSlot(to, std::move(held), heldEntity, heldVersion);
+                order[to] = to;
+            }
+        }
+
+        // Swaps two live components along with their owners and versions
+        void swapLocations(const emerald_id a, const emerald_id b) {
+            if(a != b) {
+                comp_t held(std::move(slot(a)));
+                slot(a).~comp_t();
+                auto heldEntity = denseAt(a);
+                auto heldVersion = getVersion(a);
+                moveSlot(b, a);
+                placeSlot(b, std::move(held), heldEntity, heldVersion);
+            }
+        }
+
+        // Only packed pools can be owned, and only by one group
+        void setGroup(IBaseGroup* group) {
+            static_assert(is_packed, "Only packed pools can be owned by a group");
+            if(group != nullptr && m_group != nullptr) {
+                throw BadComponent("Component is already owned by another group");
+            }
+            m_group = group;
+        }
+
+        IBaseGroup* getGroup() const {
+            return m_group;
+        }
+
+        // Any number of watchers can follow a pool, unlike the group that owns it they never move components
+        void addWatcher(IBaseGroup* watcher) {
+            m_watchers.push_back(watcher);
+        }
+
+        // Nothing is recorded for an event until it has an observer
+        void onAdd(pool_observer_t observer) {
+            m_onAdd.push_back(std::move(observer));
+        }
+
+        void onRemove(pool_observer_t observer) {
+            m_onRemove.push_back(std::move(observer));
+        }
+
+        // Found from the slot versions when events are flushed, so a new component counts as updated too
+        void onUpdate(pool_observer_t observer) {
+            static_assert(tracks_changes, "onUpdate needs a component that tracks changes");
+            if(m_onUpdate.size() == 0) {
+                m_observedTick = getTick();
+            }
+            m_onUpdate.push_back(std::move(observer));
+        }
+
+        // Hands observers the entities that lost, got or updated their component since the last flush. Only
+        // added components that still exist are passed on. Events caused by observers wait for the next flush
+        void flushEvents() override {
+            if(m_removed.size() > 0) {
+                m_batch.swap(m_removed);
+                m_removed.clear();
+                for(auto& observer : m_onRemove) {
+                    observer(m_batch);
+                }
+            }
+            if(m_added.size() > 0) {
+                m_batch.swap(m_added);
+                m_added.clear();
+                m_batch.erase(std::remove_if(m_batch.begin(), m_batch.end(), [this](emerald_entity id) {
+                    return !hasComponent(id);
+                }), m_batch.end());
+                for(auto& observer : m_onAdd) {
+                    observer(m_batch);
+                }
+            }
+            if constexpr(tracks_changes) {
+                if(m_onUpdate.size() > 0) {
+                    m_batch.clear();
+                    for(emerald_id location = 0; location < m_poolTop; location++) {
+                        if(isOccupied(location) && getVersion(location) > m_observedTick) {
+                            m_batch.push_back(denseAt(location));
+                        }
+                    }
+                    m_observedTick = getTick();
+                    if(m_batch.size() > 0) {
+                        for(auto& observer : m_onUpdate) {
+                            observer(m_batch);
+                        }
+                    }
+                }
+            }
+            m_batch.clear();
+        }
+
+        // Writes are stamped with the value tick holds at the time, the manager owning the pool sets this
+        void setTickSource(const std::atomic<emerald_tick>* tick) {
+            m_tick = tick;
+        }
+
+        emerald_tick getTick() const {
+            return m_tick != nullptr ? m_tick->load(std::memory_order_relaxed) : 0;
+        }
+
+        // The manager owning the pool keeps a signature per entity, bit is set in it for every entity with a
+        // component here. The table has to cover every entity the pool is given
+        void setSignatures(std::pmr::vector<Signature>* signatures, const std::size_t bit) {
+            m_signatures = signatures;
+            m_signatureBit = bit;
+        }
+
+        std::size_t getPageCount() const {
+            return m_pages.size();
+        }
+
     private:
-        Component<comp_t>* m_poolBasePtr;
+        static constexpr bool tracks_changes = tracks_changes_v<comp_t>;
+        static constexpr std::size_t sparse_page_shift = 12;
+
+        comp_t& slot(const emerald_id location) {
+            return slotAt<comp_t>(m_pages.data(), location);
+        }
+
+        static constexpr std::size_t sparse_page_size = std::size_t(1) << sparse_page_shift;
+        static constexpr std::size_t page_bytes = (sizeof(comp_t) * page_size + cache_line_size - 1) / cache_line_size * cache_line_size;
+        static constexpr std::size_t page_alignment = std::max(cache_line_size, alignof(comp_t));
+
+        // Component pages are cache line aligned so parallel chunks never share a line, every one comes
+        // with a page of owners
+        void addPage() {
+            m_pages.push_back(static_cast<comp_t*>(m_resource->allocate(page_bytes, page_alignment)));
+            m_dense.push_back(allocateArray(page_size, invalid_entity));
+            if constexpr(tracks_changes) {
+                m_versions.push_back(allocateArray<emerald_tick>(page_size, 0));
+            }
+        }
+
+        // Frees the last page, whatever was in it has to be gone already
+        void releasePage() {
+            m_resource->deallocate(m_pages.back(), page_bytes, page_alignment);
+            m_pages.pop_back();
+            deallocateArray(m_dense.back(), page_size);
+            m_dense.pop_back();
+            if constexpr(tracks_changes) {
+                deallocateArray(m_versions.back(), page_size);
+                m_versions.pop_back();
+            }
+        }
+
+        template<typename value_t>
+        value_t* allocateArray(const std::size_t count, const value_t fill) {
+            auto array = static_cast<value_t*>(m_resource->allocate(count * sizeof(value_t), alignof(value_t)));
+            std::fill_n(array, count, fill);
+            return array;
+        }
+
+        template<typename value_t>
+        void deallocateArray(value_t* array, const std::size_t count) {
+            m_resource->deallocate(array, count * sizeof(value_t), alignof(value_t));
+        }
+
+        // Moves a live component, its version and its owner into an empty slot
+        void moveSlot(const emerald_id from, const emerald_id to) {
+            new(&slot(to)) comp_t(std::move(slot(from)));
+            slot(from).~comp_t();
+            if constexpr(tracks_changes) {
+                slotAt<comp_t>(m_versions.data(), to) = slotAt<comp_t>(m_versions.data(), from);
+            }
+            denseAt(to) = denseAt(from);
+            sparseAt(entityIndex(denseAt(to))) = to;
+            denseAt(from) = invalid_entity;
+        }
+
+        void placeSlot(const emerald_id location, comp_t&& component, const emerald_entity entID, const emerald_tick version) {
+            new(&slot(location)) comp_t(std::move(component));
+            denseAt(location) = entID;
+            sparseAt(entityIndex(entID)) = location;
+            if constexpr(tracks_changes) {
+                slotAt<comp_t>(m_versions.data(), location) = version;
+            }
+        }
+
+        // After the pool is cleared or loaded
+        void rebuildGroups() {
+            for(auto watcher : m_watchers) {
+                watcher->rebuild();
+            }
+            if(m_group != nullptr) {
+                m_group->rebuild();
+            }
+        }
+
+        // Lowers the top past any holes under it, the free list is sorted so those are at its back
+        void trimTop() {
+            if constexpr(!is_packed) {
+                while(m_poolTop > 0 && !isOccupied(m_poolTop - 1)) {
+                    m_poolTop--;
+                }
+                while(m_freeLocations.size() > 0 && m_freeLocations.back() >= m_poolTop) {
+                    m_freeLocations.pop_back();
+                }
+            }
+        }
+
+        emerald_entity& denseAt(const emerald_id location) {
+            return m_dense[location >> pool_page_shift_v<comp_t>][location & (page_size - 1)];
+        }
+
+        const emerald_entity& denseAt(const emerald_id location) const {
+            return m_dense[location >> pool_page_shift_v<comp_t>][location & (page_size - 1)];
+        }
+
+        // The sparse array is paged too, pages for entity ranges that never had this component aren't allocated
+        emerald_id& sparseAt(const emerald_id index) {
+            auto page = index >> sparse_page_shift;
+            if(page >= m_sparse.size()) {
+                m_sparse.resize(page + 1, nullptr);
+            }
+            if(m_sparse[page] == nullptr) {
+                m_sparse[page] = allocateArray(sparse_page_size, invalid_id);
+            }
+            return m_sparse[page][index & (sparse_page_size - 1)];
+        }
+
+        std::pmr::memory_resource* m_resource;
+        std::pmr::vector<comp_t*> m_pages;
         emerald_id m_poolTop;
-        std::stack<emerald_id> m_freeLocations;
-        std::size_t m_poolSize;
+        // Used as a stack, compact sorts it and it stays sorted until a hole is pushed out of order
+        std::pmr::deque<emerald_id> m_freeLocations;
+        bool m_freeSorted = true;
+        Bitset m_occupied;
+        std::pmr::vector<emerald_id*> m_sparse;
+        std::pmr::vector<emerald_entity*> m_dense;
+        std::pmr::vector<emerald_tick*> m_versions;
+        const std::atomic<emerald_tick>* m_tick = nullptr;
+        std::pmr::vector<Signature>* m_signatures = nullptr;
+        std::size_t m_signatureBit = 0;
+        std::vector<pool_observer_t> m_onAdd;
+        std::vector<pool_observer_t> m_onRemove;
+        std::vector<pool_observer_t> m_onUpdate;
+        std::vector<emerald_entity> m_added;
+        std::vector<emerald_entity> m_removed;
+        std::vector<emerald_entity> m_batch;
+        emerald_tick m_observedTick = 0;
+        std::pmr::vector<std::pair<emerald_entity, emerald_tick>> m_removals;
+        IBaseGroup* m_group = nullptr;
+        std::vector<IBaseGroup*> m_watchers;
+    };
+
+    // A tag is nothing but its bit in the signature of every entity that has one, so the pool has no pages and
+    // a tag's location is its owner's index in the entity table. Every tag handed out is the same empty
+    // instance. The pool only works attached to a manager, which gives it both tables
+    template<typename comp_t>
+    class ComponentPool<comp_t, std::enable_if_t<is_tag_v<comp_t>>> : public IBaseComponentPool {
+    public:
+        // Only the logs kept for deltas allocate, from resource
+        ComponentPool(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_removals(resource)
+        , m_additions(resource) {
+            static_assert(!tracks_changes_v<comp_t>, "Tags have nothing to track changes in");
+        }
+
+        ComponentPool(const ComponentPool&) = delete;
+        ComponentPool& operator=(const ComponentPool&) = delete;
+
+        // There's nothing to construct, so args are ignored
+        template<typename... args_t>
+        emerald_id createComponent(const emerald_entity entID, args_t&&...) {
+            auto index = entityIndex(entID);
+            if(!isOccupied(index)) {
+                (*m_signatures)[index].set(m_signatureBit);
+                m_size++;
+                if(m_logStart != no_log) {
+                    m_additions.emplace_back(entID, getTick());
+                }
+                if(m_onAdd.size() > 0) {
+                    m_added.push_back(entID);
+                }
+                for(auto watcher : m_watchers) {
+                    watcher->onCreate(entID);
+                }
+            }
+            return index;
+        }
+
+        void deleteComponent(const emerald_id location) override {
+            if(isOccupied(location)) {
+                auto entID = (*m_entities)[location];
+                for(auto watcher : m_watchers) {
+                    watcher->onDelete(entID);
+                }
+                if(m_onRemove.size() > 0) {
+                    m_removed.push_back(entID);
+                }
+                if(m_logStart != no_log) {
+                    m_removals.emplace_back(entID, getTick());
+                }
+                (*m_signatures)[location].reset(m_signatureBit);
+                m_size--;
+            }
+        }
+
+        // Tags never need room
+        void reserve(const std::size_t) {}
+
+        std::size_t getSize() const {
+            return m_size;
+        }
+
+        void removeComponent(const emerald_entity entID) override {
+            if(auto location = getLocation(entID); location != invalid_id) {
+                deleteComponent(location);
+            }
+        }
+
+        // Returns invalid_id for stale handles, the entity table has to hold the whole handle
+        emerald_id getLocation(const emerald_entity entID) const {
+            auto index = entityIndex(entID);
+            return isOccupied(index) && (*m_entities)[index] == entID ? index : invalid_id;
+        }
+
+        bool hasComponent(const emerald_entity entID) const override {
+            return getLocation(entID) != invalid_id;
+        }
+
+        emerald_entity getEntity(const emerald_id location) const {
+            return isOccupied(location) ? (*m_entities)[location] : invalid_entity;
+        }
+
+        bool isOccupied(const emerald_id location) const {
+            return location < getTop() && (*m_signatures)[location].test(m_signatureBit);
+        }
+
+        // Any entity could have the tag, so views walk the whole entity table
+        std::size_t getTop() const {
+            return m_entities != nullptr ? m_entities->size() : 0;
+        }
+
+        comp_t& getComponent(const emerald_id id) {
+            return const_cast<comp_t&>(std::as_const(*this).getComponent(id));
+        }
+
+        const comp_t& getComponent(const emerald_id id) const {
+            if(isOccupied(id)) {
+                return shared_tag;
+            } else {
+                throw std::runtime_error("getComponent() invalid id");
+            }
+        }
+
+        comp_t& getSlot(const emerald_id) {
+            return shared_tag;
+        }
+
+        comp_t& writeSlot(const emerald_id) {
+            return shared_tag;
+        }
+
+        const comp_t& getSlot(const emerald_id) const {
+            return shared_tag;
+        }
+
+        emerald_tick getVersion(const emerald_id) const {
+            return 0;
+        }
+
+        bool changedSince(const emerald_id, const emerald_tick) const {
+            return false;
+        }
+
+        void markChanged(const emerald_id) {}
+
+        // Takes the tag off every entity, observers stay but their pending events are dropped
+        void clear() override {
+            if(m_signatures != nullptr) {
+                for(auto& signature : *m_signatures) {
+                    signature.reset(m_signatureBit);
+                }
+            }
+            m_size = 0;
+            m_added.clear();
+            m_removed.clear();
+            m_removals.clear();
+            m_additions.clear();
+            if(m_logStart != no_log) {
+                m_logStart = getTick();
+            }
+            rebuildWatchers();
+        }
+
+        // A tag has no column to save, only the entities that have it are written
+        void saveSnapshot(SnapshotWriter& writer) const {
+            writer.write<uint64_t>(sizeof(comp_t));
+            writer.write<uint64_t>(m_size);
+            forEachOwner([&writer](const emerald_entity entID) {
+                writer.write(entID);
+            });
+        }
+
+        // Tags the entities saved by saveSnapshot. Each has to be live in entities, the entity table loaded with
+        // the snapshot, and listed once. Anything else throws BadSnapshot and leaves the pool empty
+        void loadSnapshot(SnapshotReader& reader, const std::pmr::vector<emerald_entity>& entities) {
+            clear();
+            if(reader.read<uint64_t>() != sizeof(comp_t)) {
+                throw BadSnapshot("Snapshot component size doesn't match");
+            }
+            auto count = reader.read<uint64_t>();
+            if(count > reader.getRemaining() / sizeof(emerald_entity)) {
+                throw BadSnapshot("Snapshot is truncated");
+            }
+            for(; count > 0; count--) {
+                auto owner = reader.read<emerald_entity>();
+                if(entityIndex(owner) >= entities.size() || entities[entityIndex(owner)] != owner || isOccupied(entityIndex(owner))) {
+                    clear();
+                    throw BadSnapshot("Snapshot component owner isn't a live entity");
+                }
+                (*m_signatures)[entityIndex(owner)].set(m_signatureBit);
+                m_size++;
+            }
+            rebuildWatchers();
+        }
+
+        // Writes the entities that lost or got the tag after tick since, or every entity that has it when since
+        // is older than the log. The log starts with the first delta made
+        void saveDelta(SnapshotWriter& writer, const emerald_tick since) {
+            writer.write<uint64_t>(sizeof(comp_t));
+            auto full = since < m_logStart;
+            writer.write<uint8_t>(full);
+            if(full) {
+                writer.write<uint64_t>(m_size);
+                forEachOwner([&writer](const emerald_entity entID) {
+                    writer.write(entID);
+                });
+                if(m_logStart == no_log) {
+                    m_logStart = getTick();
+                }
+            } else {
+                auto removed = std::partition_point(m_removals.begin(), m_removals.end(), [since](const auto& removal) {
+                    return removal.second <= since;
+                });
+                writer.write<uint64_t>(m_removals.end() - removed);
+                for(; removed != m_removals.end(); ++removed) {
+                    writer.write(removed->first);
+                }
+                auto added = std::partition_point(m_additions.begin(), m_additions.end(), [since](const auto& addition) {
+                    return addition.second <= since;
+                });
+                writer.write<uint64_t>(std::count_if(added, m_additions.end(), [this](const auto& addition) {
+                    return hasComponent(addition.first);
+                }));
+                for(; added != m_additions.end(); ++added) {
+                    if(hasComponent(added->first)) {
+                        writer.write(added->first);
+                    }
+                }
+            }
+        }
+
+        // Takes the tag off and puts it on the entities saveDelta listed, observers are told as usual. Only
+        // entities live in entities are tagged, anything else throws BadSnapshot
+        void loadDelta(SnapshotReader& reader, const std::pmr::vector<emerald_entity>& entities) {
+            auto live = [&entities](const emerald_entity entID) {
+                if(entityIndex(entID) >= entities.size() || entities[entityIndex(entID)] != entID) {
+                    throw BadSnapshot("Delta component owner isn't a live entity");
+                }
+            };
+            if(reader.read<uint64_t>() != sizeof(comp_t)) {
+                throw BadSnapshot("Delta component size doesn't match");
+            }
+            if(reader.read<uint8_t>() != 0) {
+                // Every entity that has the tag, anything else loses it
+                auto count = reader.read<uint64_t>();
+                if(count > reader.getRemaining() / sizeof(emerald_entity)) {
+                    throw BadSnapshot("Snapshot is truncated");
+                }
+                std::vector<emerald_entity> tagged(count);
+                reader.readInto(tagged.data(), count * sizeof(emerald_entity));
+                std::for_each(tagged.begin(), tagged.end(), live);
+                std::sort(tagged.begin(), tagged.end());
+                std::vector<emerald_entity> untagged;
+                forEachOwner([&tagged, &untagged](const emerald_entity entID) {
+                    if(!std::binary_search(tagged.begin(), tagged.end(), entID)) {
+                        untagged.push_back(entID);
+                    }
+                });
+                for(auto entID : untagged) {
+                    removeComponent(entID);
+                }
+                for(auto entID : tagged) {
+                    createComponent(entID);
+                }
+            } else {
+                for(auto removed = reader.read<uint64_t>(); removed > 0; removed--) {
+                    removeComponent(reader.read<emerald_entity>());
+                }
+                for(auto added = reader.read<uint64_t>(); added > 0; added--) {
+                    auto entID = reader.read<emerald_entity>();
+                    live(entID);
+                    createComponent(entID);
+                }
+            }
+        }
+
+        // Entities that lost or got the tag are remembered for deltas until they're forgotten, deltas made since
+        // tick or later don't need the ones up to it
+        void forgetChanges(const emerald_tick tick) {
+            m_removals.erase(m_removals.begin(), std::partition_point(m_removals.begin(), m_removals.end(), [tick](const auto& removal) {
+                return removal.second <= tick;
+            }));
+            m_additions.erase(m_additions.begin(), std::partition_point(m_additions.begin(), m_additions.end(), [tick](const auto& addition) {
+                return addition.second <= tick;
+            }));
+        }
+
+        // The delta logs are all a tag allocates, however many entities have it
+        PoolStats getStats() const override {
+            PoolStats stats;
+            stats.live = m_size;
+            stats.bytes = (m_removals.capacity() + m_additions.capacity()) * sizeof(m_removals[0]);
+            return stats;
+        }
+
+        // Tags never leave holes
+        bool compact(const std::size_t) override {
+            return true;
+        }
+
+        void shrinkToFit() override {
+            m_removals.shrink_to_fit();
+            m_additions.shrink_to_fit();
+        }
+
+        // Any number of watchers can follow a tag, they're told after it's added and before it's removed
+        void addWatcher(IBaseGroup* watcher) {
+            m_watchers.push_back(watcher);
+        }
+
+        // Nothing is recorded for an event until it has an observer
+        void onAdd(pool_observer_t observer) {
+            m_onAdd.push_back(std::move(observer));
+        }
+
+        void onRemove(pool_observer_t observer) {
+            m_onRemove.push_back(std::move(observer));
+        }
+
+        // Hands observers the entities that lost or got the tag since the last flush. Only entities that still
+        // have it are passed on as added. Events caused by observers wait for the next flush
+        void flushEvents() override {
+            if(m_removed.size() > 0) {
+                m_batch.swap(m_removed);
+                m_removed.clear();
+                for(auto& observer : m_onRemove) {
+                    observer(m_batch);
+                }
+            }
+            if(m_added.size() > 0) {
+                m_batch.swap(m_added);
+                m_added.clear();
+                m_batch.erase(std::remove_if(m_batch.begin(), m_batch.end(), [this](emerald_entity id) {
+                    return !hasComponent(id);
+                }), m_batch.end());
+                for(auto& observer : m_onAdd) {
+                    observer(m_batch);
+                }
+            }
+            m_batch.clear();
+        }
+
+        // Logged changes are stamped with the value tick holds at the time, the manager owning the pool sets this
+        void setTickSource(const std::atomic<emerald_tick>* tick) {
+            m_tick = tick;
+        }
+
+        emerald_tick getTick() const {
+            return m_tick != nullptr ? m_tick->load(std::memory_order_relaxed) : 0;
+        }
+
+        // bit is set in the signature of every entity with the tag. Both tables are the manager's and have to
+        // cover every entity the pool is given
+        void setSignatures(std::pmr::vector<Signature>* signatures, const std::size_t bit) {
+            m_signatures = signatures;
+            m_signatureBit = bit;
+        }
+
+        void setEntities(const std::pmr::vector<emerald_entity>* entities) {
+            m_entities = entities;
+        }
+
+    private:
+        static constexpr emerald_tick no_log = std::numeric_limits<emerald_tick>::max();
+
+        inline static comp_t shared_tag{};
+
+        // Calls func with every entity that has the tag, in index order
+        template<typename func_t>
+        void forEachOwner(func_t func) const {
+            for(emerald_id index = 0; index < getTop(); index++) {
+                if((*m_signatures)[index].test(m_signatureBit)) {
+                    func((*m_entities)[index]);
+                }
+            }
+        }
+
+        // After the pool is cleared or loaded
+        void rebuildWatchers() {
+            for(auto watcher : m_watchers) {
+                watcher->rebuild();
+            }
+        }
+
+        std::size_t m_size = 0;
+        const std::atomic<emerald_tick>* m_tick = nullptr;
+        std::pmr::vector<Signature>* m_signatures = nullptr;
+        std::size_t m_signatureBit = 0;
+        const std::pmr::vector<emerald_entity>* m_entities = nullptr;
+        std::vector<pool_observer_t> m_onAdd;
+        std::vector<pool_observer_t> m_onRemove;
+        std::vector<emerald_entity> m_added;
+        std::vector<emerald_entity> m_removed;
+        std::vector<emerald_entity> m_batch;
+        std::pmr::vector<std::pair<emerald_entity, emerald_tick>> m_removals;
+        std::pmr::vector<std::pair<emerald_entity, emerald_tick>> m_additions;
+        emerald_tick m_logStart = no_log;
+        std::vector<IBaseGroup*> m_watchers;
     };
 
     template<typename comp_t>
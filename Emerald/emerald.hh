@@ -2,5 +2,7 @@
 #define _ECS_H
 
 #include "entitymanager.hh"
+#include "archetype.hh"
+#include "Util/memory.hh"
 
 #endif // _ECS_H
@@ -3,156 +3,405 @@
 
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <array>
 #include <unordered_map>
+#include <tuple>
+#include <atomic>
+#include <mutex>
+#include <exception>
 #include <iostream>
+#include <string>
+#include <typeinfo>
+#include <chrono>
+#include <limits>
+#include <algorithm>
 #include "Util/types.hh"
 #include "Util/exceptions.hh"
+#include "Util/meta.hh"
+#include "Util/signature.hh"
+#include "Util/bitset.hh"
+#include "Util/threadpool.hh"
+#include "Util/profiler.hh"
 #include "component.hh"
+#include "commandbuffer.hh"
+#include "view.hh"
+#include "group.hh"
+#include "hierarchy.hh"
 #include "system.hh"
 
 namespace Emerald {
 
+    // Components listed in registry_ts get their pools stored inline and resolved at compile time,
+    // any other component type still works but its pool is found through a runtime id
+    template<typename... registry_ts>
     class EntityManager {
     private:
-        template<typename t> struct identity { typedef t type; };
+        static_assert(is_unique<registry_ts...>::value, "EntityManager component types must be unique");
+        static_assert(sizeof...(registry_ts) <= Signature::max_components, "More component types than EMERALD_MAX_COMPONENTS");
+
+        template<typename comp_t>
+        static constexpr bool is_registered = contains_v<comp_t, registry_ts...>;
 
     public:
-        EntityManager() : m_entityCount(0) {}
+        typedef CommandBuffer<EntityManager> command_buffer;
 
-        emerald_id createEntity() {
-            m_entities[m_entityCount] = std::vector<emerald_long>();
-            return m_entityCount++;
+        // The pools and the entity table allocate from resource, which has to outlive the manager
+        EntityManager(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_resource(resource)
+        , m_entityCount(0)
+        , m_tick(1)
+        , m_entities(resource)
+        , m_freeEntities(resource)
+        , m_entityVersions(resource)
+        , m_signatures(resource)
+        , m_hierarchy(resource)
+        , m_pools(((void)sizeof(registry_ts), resource)...) {
+            m_commandBuffers.push_back(std::make_unique<command_buffer>());
+            (attachPool(*getPool<registry_ts>(), index_of<registry_ts, registry_ts...>::value), ...);
         }
 
-        void removeEntity(const emerald_id id) {
-            if(auto iter = m_entities.find(id); iter != m_entities.end()) {
-                for(auto id : iter->second) {
-                    emerald_id type = (id >> 16);
-                    emerald_id loc = id & comp_id_mask;
-                    m_components[type]->deleteComponent(loc);
-                }
-                m_entities.erase(iter);
+        EntityManager(const EntityManager&) = delete;
+        EntityManager& operator=(const EntityManager&) = delete;
+
+        emerald_entity createEntity() {
+            emerald_id index;
+            if(m_freeEntities.size() > 0) {
+                index = m_freeEntities.back();
+                m_freeEntities.pop_back();
+                m_entities[index] = makeEntity(index, entityGeneration(m_entities[index]));
+            } else if(m_entities.size() < max_entities) {
+                index = m_entities.size();
+                m_entities.push_back(makeEntity(index, 0));
+                m_entityVersions.push_back(0);
+                m_signatures.emplace_back();
+            } else {
+                throw BadID("createEntity entity limit reached");
+            }
+            m_entityVersions[index] = m_tick;
+            m_entityCount++;
+            EMERALD_PROFILE_CHANGES(1);
+            return m_entities[index];
+        }
+
+        // Creates amount entities at once, free indices are reused first and the entity table grows once.
+        // initializer is called with every new entity and its position in the batch
+        template<typename func_t>
+        std::vector<emerald_entity> createEntities(const std::size_t amount, func_t initializer) {
+            auto ids = allocateEntities(amount);
+            for(std::size_t i = 0; i < ids.size(); i++) {
+                initializer(ids[i], i);
             }
+            return ids;
         }
 
+        std::vector<emerald_entity> createEntities(const std::size_t amount) {
+            return allocateEntities(amount);
+        }
+
+        // Creates amount entities that each get a copy of every prototype, every pool is grown once and
+        // then filled in one pass
         template<typename... comp_ts>
-        void mapEntities(std::function<void(const emerald_id)> func) {
-            for(auto& [id, list] : m_entities) {
-                if(entityHasComponents<comp_ts...>(id)) {
-                    func(id);
+        std::vector<emerald_entity> createEntitiesWith(const std::size_t amount, const comp_ts&... prototypes) {
+            auto ids = allocateEntities(amount);
+            auto fill = [&ids](auto pool, const auto& prototype) {
+                pool->reserve(ids.size());
+                for(auto id : ids) {
+                    pool->createComponent(id, prototype);
+                }
+            };
+            (fill(getOrCreatePool<comp_ts>(), prototypes), ...);
+            EMERALD_PROFILE_CHANGES(amount * sizeof...(comp_ts));
+            return ids;
+        }
+
+        // Makes room in every per entity table for amount more entities, past the free indices they'd reuse
+        void reserveEntities(const std::size_t amount) {
+            auto size = m_entities.size() + amount - std::min(amount, m_freeEntities.size());
+            m_entities.reserve(size);
+            m_entityVersions.reserve(size);
+            m_signatures.reserve(size);
+        }
+
+        // The index is recycled with its generation bumped, so any handle still held to the entity goes stale
+        void removeEntity(const emerald_entity id) {
+            if(isEntityValid(id)) {
+                EMERALD_PROFILE_CHANGES(1);
+                removeComponents(id);
+                m_hierarchy.remove(id);
+                auto generation = entityGeneration(id) + 1;
+                if(generation == placeholder_generation) {
+                    generation = 0;
                 }
+                m_entities[entityIndex(id)] = makeEntity(dead_index, generation);
+                m_entityVersions[entityIndex(id)] = m_tick;
+                m_freeEntities.push_back(entityIndex(id));
+                m_entityCount--;
             }
         }
 
-        template<typename... comp_ts>
-        bool entityHasComponents(const emerald_id entID) const {
-            return ((entityHasComponent<comp_ts>(entID) != invalid_id) && ...);
+        bool isEntityValid(const emerald_entity id) const {
+            auto index = entityIndex(id);
+            return index < m_entities.size() && m_entities[index] == id;
         }
 
-        template<typename comp_t>
-        emerald_id entityHasComponent(const emerald_id entID) const {
-            if(auto iter = m_entities.find(entID); iter != m_entities.end()) {
-                auto compID = getComponentID<comp_t>();
-                for(auto comptag : iter->second) {
-                    if((comptag & comp_type_mask) >> 16 == compID) {
-                        return comptag & comp_id_mask;
+        // Without component types every live entity is mapped, otherwise the ones whose signature has all of
+        // comp_ts, found by scanning the signatures 64 entities at a time
+        template<typename... comp_ts, typename func_t>
+        void mapEntities(func_t func) {
+            EMERALD_PROFILE_VISITS(m_entities.size());
+            if constexpr(sizeof...(comp_ts) == 0) {
+                for(emerald_id index = 0; index < m_entities.size(); index++) {
+                    if(auto id = m_entities[index]; entityIndex(id) == index) {
+                        func(id);
+                    }
+                }
+            } else {
+                Signature mask;
+                if(!makeMask<comp_ts...>(mask)) {
+                    return;
+                }
+                for(std::size_t begin = 0; begin < m_signatures.size(); begin += Bitset::word_bits) {
+                    auto hits = matchSignatures(m_signatures.data() + begin, std::min(Bitset::word_bits, m_signatures.size() - begin), mask);
+                    for(; hits != 0; hits &= hits - 1) {
+                        func(m_entities[begin + countTrailingZeros(hits)]);
                     }
                 }
             }
+        }
+
+        // Owning group of comp_ts, created the first time it's asked for. Entities with every one of them are
+        // kept at the front of each pool in the same order, so mapping the group walks the pools side by side.
+        // The pools have to be packed and can only be owned by one group
+        template<typename... comp_ts>
+        Group<comp_ts...>& group() {
+            auto groupID = Group<comp_ts...>::getGroupID();
+            if(groupID >= m_groups.size()) {
+                m_groups.resize(groupID + 1);
+            }
+            if(!m_groups[groupID]) {
+                m_groups[groupID] = std::make_unique<Group<comp_ts...>>(getOrCreatePool<comp_ts>()...);
+            }
+            return static_cast<Group<comp_ts...>&>(*m_groups[groupID]);
+        }
+
+        // Makes child a child of parent, or a root when parent is invalid_entity. Removing an entity takes it out
+        // of the hierarchy and makes its children roots
+        void setParent(const emerald_entity child, const emerald_entity parent) {
+            if(!isEntityValid(child) || (parent != invalid_entity && !isEntityValid(parent))) {
+                throw BadID("setParent invalid entity id");
+            }
+            m_hierarchy.setParent(child, parent);
+        }
+
+        Hierarchy& getHierarchy() {
+            return m_hierarchy;
+        }
+
+        // Calls func(comp_t& child, const comp_t& parent) for every entity in the hierarchy whose parent has a
+        // comp_t too, parents before children. comp_t's pool is put in hierarchy order first, so the walk is
+        // linear in memory. Moves components when the pool changed since the last time, like sort
+        template<typename comp_t, typename func_t>
+        void propagate(func_t func) {
+            if(auto pool = getPool<comp_t>(); pool != nullptr) {
+                m_hierarchy.propagate(*pool, func);
+            }
+        }
+
+        // Orders comp_t's pool by compare, which takes two components or two entities. Moves components, so
+        // locations and references into the pool don't survive it
+        template<typename comp_t, typename compare_t>
+        void sort(compare_t compare) {
+            static_assert(!is_tag_v<comp_t>, "Tags have no components to sort");
+            getOrCreatePool<comp_t>()->sort(compare);
+        }
+
+        // Iterable join of the entities that have every one of comp_ts, use map for the fastest loop
+        template<typename... comp_ts>
+        View<comp_ts...> view() {
+            return View<comp_ts...>(getPool<std::remove_const_t<comp_ts>>()...);
+        }
+
+        // One mask compare against the entity's signature
+        template<typename... comp_ts>
+        bool entityHasComponents(const emerald_entity entID) const {
+            Signature mask;
+            return isEntityValid(entID) && makeMask<comp_ts...>(mask) && m_signatures[entityIndex(entID)].contains(mask);
+        }
+
+        // Bit i is set when the entity has a component of the i-th type the manager was declared with, types
+        // it wasn't declared with get the bits after those as their pools are created
+        const Signature& getSignature(const emerald_entity entID) const {
+            if(!isEntityValid(entID)) {
+                throw BadID("getSignature invalid entity id");
+            }
+            return m_signatures[entityIndex(entID)];
+        }
+
+        template<typename comp_t>
+        emerald_id entityHasComponent(const emerald_entity entID) const {
+            if(auto pool = getPool<comp_t>(); pool != nullptr) {
+                return pool->getLocation(entID);
+            }
             return invalid_id;
         }
 
         std::size_t getEntityCount() const {
-            return m_entities.size();
+            return m_entityCount;
         }
 
         template<typename comp_t>
         PoolView<comp_t> getComponentView() {
-            if(auto iter = m_components.find(getComponentID<comp_t>()); iter != m_components.end()) {
-                return static_cast<ComponentPool<comp_t>*>(iter->second.get())->getComponentView();
+            static_assert(!is_tag_v<comp_t>, "Tags have no components to view, join them in a view instead");
+            if(auto pool = getPool<comp_t>(); pool != nullptr) {
+                return pool->getComponentView();
             } else {
                 throw BadType("getComponentView invalid component type");
             }
         }
 
         template<typename comp_t, typename... args_t>
-        std::enable_if_t<std::is_constructible<comp_t, args_t...>::value, emerald_id> createComponent(const emerald_id id, args_t&&... args) {
-            auto compID = getComponentID<comp_t>();
-            if(auto cid = entityHasComponent<comp_t>(id); cid != invalid_id) {
-                return cid & comp_id_mask;
+        std::enable_if_t<std::is_constructible<comp_t, args_t...>::value, emerald_id> createComponent(const emerald_entity id, args_t&&... args) {
+            if(!isEntityValid(id)) {
+                throw BadID("createComponent invalid entity id");
             }
-            if(m_components.find(compID) == m_components.end()) {
-                m_components[compID] = std::make_unique<ComponentPool<comp_t>>();
+            auto pool = getOrCreatePool<comp_t>();
+            if(auto cid = pool->getLocation(id); cid != invalid_id) {
+                return cid;
             }
-            auto cid = static_cast<ComponentPool<comp_t>*>(m_components[compID].get())->createComponent(id, std::forward<args_t>(args)...);
-            m_entities[id].push_back((compID << 16) | cid);
-            return cid;
+            EMERALD_PROFILE_CHANGES(1);
+            return pool->createComponent(id, std::forward<args_t>(args)...);
+        }
+
+        // Makes room for amount more components up front, so adding them doesn't grow the pool one page at a time
+        template<typename comp_t>
+        void reserve(const std::size_t amount) {
+            getOrCreatePool<comp_t>()->reserve(amount);
         }
 
         template<typename... comp_ts>
-        std::tuple<comp_ts&&...> getComponents(const emerald_id id) {
+        std::tuple<comp_ts&&...> getComponents(const emerald_entity id) {
             return {std::forward<comp_ts>(getComponent<comp_ts>(id))...};
         }
 
         template<typename comp_t>
-        comp_t& getComponent(const emerald_id id) {
-            auto compID = getComponentID<comp_t>();
-            if(auto loc = entityHasComponent<comp_t>(id); loc != invalid_id) {
-                return static_cast<ComponentPool<comp_t>*>(m_components[compID].get())->getComponent(loc);
-            } else {
+        comp_t& getComponent(const emerald_entity id) {
+            auto pool = getPool<comp_t>();
+            if(pool == nullptr) {
                 throw BadType("getComponent invalid component type");
+            } else if(auto loc = pool->getLocation(id); loc != invalid_id) {
+                return pool->getComponent(loc);
+            } else {
+                throw BadType("getComponent Entity doesn't have component");
             }
         }
 
         template<typename comp_t>
-        const comp_t& getComponent(const emerald_id id) const {
-            auto compID = getComponentID<comp_t>();
-            auto loc = entityHasComponent<comp_t>(id);
-            if(loc != invalid_id) {
-                if(auto iter = m_components.find(compID); iter != m_components.end()) {
-                    auto& [id, uptr] = *iter;
-                    return static_cast<const ComponentPool<comp_t>*>(uptr.get())->getComponent(loc);
-                } else {
-                    throw BadType("getComponent const invalid component type");
-                }
+        const comp_t& getComponent(const emerald_entity id) const {
+            auto pool = getPool<comp_t>();
+            if(pool == nullptr) {
+                throw BadType("getComponent const invalid component type");
+            } else if(auto loc = pool->getLocation(id); loc != invalid_id) {
+                return pool->getComponent(loc);
             } else {
                 throw BadType("getComponent const Entity doesn't have component");
             }
         }
 
+        // getComponent doesn't stamp components that track changes, so systems that only read them can share
+        // the pool. Code that writes through it marks what it changed, views of non const types do it for you
         template<typename comp_t>
-        void removeComponent(const emerald_id id) {
-            auto iter = m_components.find(getComponentID<comp_t>());
-            if(iter != m_components.end()) {
-                iter->second->deleteComponent(id);
+        void markChanged(const emerald_entity id) {
+            if(auto pool = getPool<comp_t>(); pool != nullptr) {
+                if(auto loc = pool->getLocation(id); loc != invalid_id) {
+                    pool->markChanged(loc);
+                }
             }
         }
 
-        template<typename... comp_ts>
-        void mapComponents(typename identity<std::function<void(comp_ts&...)>>::type func) {
-            for(auto [id, cv] : m_entities) {
-                if(entityHasComponents<comp_ts...>(id)) {
-                    func(static_cast<ComponentPool<comp_ts>*>(m_components[getComponentID<comp_ts>()].get())->getComponent(id)...);
-                }
+        template<typename comp_t>
+        void removeComponent(const emerald_entity id) {
+            if(auto pool = getPool<comp_t>(); pool != nullptr) {
+                EMERALD_PROFILE_CHANGES(pool->hasComponent(id));
+                pool->removeComponent(id);
             }
         }
 
+        template<typename... comp_ts, typename func_t>
+        void mapComponents(func_t func) {
+            view<comp_ts...>().map([&func](const emerald_entity, comp_ts&... comps) {
+                func(comps...);
+            });
+        }
+
+        // Splits the first component's pool into cache line aligned chunks and maps the entities in
+        // them that have every component on the worker threads, or inline without workers
+        template<typename... comp_ts, typename func_t>
+        void parallelMapComponents(func_t func, const std::size_t grain = default_grain) {
+            parallelMapLead<comp_ts...>(grain, [&func](std::size_t, auto&... comps) {
+                func(comps...);
+            });
+        }
+
+        // Like parallelMapComponents but func also gets the calling thread's slot in locals
+        template<typename... comp_ts, typename local_t, typename func_t>
+        void parallelMapComponents(PerThread<local_t>& locals, func_t func, const std::size_t grain = default_grain) {
+            parallelMapLead<comp_ts...>(grain, [&func, &locals](std::size_t worker, auto&... comps) {
+                func(comps..., locals[worker]);
+            });
+        }
+
+        // Systems run in registration order unless worker threads are enabled, then systems whose
+        // declared component access doesn't conflict run at the same time. Conflicting systems still
+        // run in registration order. The pools of every component a system declares keep its members
         template<typename system_t, typename... args_t>
         void registerSystem(args_t&&... args) {
             const auto system_id = system_t::getSystemID();
-            if(auto iter = m_systems.find(system_id); iter == m_systems.end()) {
-                m_systems[system_id] = std::make_unique<system_t>(std::forward<args_t>(args)...);
-            } else {
-                BadType("System of type already exists");
+            if(findSystem(system_id) != nullptr) {
+                throw BadSystem("System of type already exists");
+            }
+            SystemEntry entry {
+                std::make_unique<system_t>(std::forward<args_t>(args)...),
+                [](IBaseSystem& system, EntityManager& entMan) {
+                    static_cast<system_t&>(system).update(entMan);
+                },
+                system_t::getAccess(),
+                {},
+                0
+            };
+            auto& members = static_cast<system_t&>(*entry.system).getEntities();
+            Signature mask;
+            system_t::forEachComponent([this, &members, &mask](auto tag) {
+                typedef typename decltype(tag)::type comp_t;
+                auto pool = getOrCreatePool<comp_t>();
+                Signature bit;
+                makeMask<comp_t>(bit);
+                if(!mask.contains(bit)) {
+                    pool->addWatcher(&members);
+                    makeMask<comp_t>(mask);
+                }
+            });
+            members.attach(&m_entities, &m_signatures, mask);
+            for(std::size_t i = 0; i < m_systems.size(); i++) {
+                if(m_systems[i].access.conflictsWith(entry.access)) {
+                    m_systems[i].dependents.push_back(m_systems.size());
+                    entry.dependencies++;
+                }
+            }
+            if(system_id >= m_systemLookup.size()) {
+                m_systemLookup.resize(system_id + 1, invalid_id);
             }
+            m_systemLookup[system_id] = m_systems.size();
+            m_systems.push_back(std::move(entry));
+#ifdef EMERALD_PROFILE
+            m_profiler.template addSystem<system_t>();
+#endif
         }
 
         template<typename system_t>
         system_t& getSystem() {
-            auto system = m_systems.find(system_t::getSystemID());
-            if(system != m_systems.end()) {
-                return *(static_cast<system_t*>(system->second.get()));
+            if(auto system = findSystem(system_t::getSystemID()); system != nullptr) {
+                return *(static_cast<system_t*>(system->system.get()));
             } else {
                 throw BadSystem("System not found");
             }
@@ -160,25 +409,690 @@ namespace Emerald {
 
         template<typename system_t>
         const system_t& getSystem() const {
-            auto system = m_systems.find(system_t::getSystemID());
-            if(system != m_systems.end()) {
-                return *(system->second.get());
+            if(auto system = findSystem(system_t::getSystemID()); system != nullptr) {
+                return *(static_cast<const system_t*>(system->system.get()));
             } else {
                 throw BadSystem("System not found");
             }
         }
 
+        // Commands recorded into getCommandBuffer() while the systems ran are flushed once they're all done.
+        // Every system update gets its own tick, and changes made after updateSystems get another
         void updateSystems() {
-            for(auto& iter : m_systems) {
-                iter.second->update(*this);
+            EMERALD_PROFILE_SPAN(m_profiler, "updateSystems");
+            if(!m_threadPool || m_systems.size() < 2) {
+                for(std::size_t i = 0; i < m_systems.size(); i++) {
+                    runSystem(i);
+                }
+            } else {
+                runSystemGraph();
+            }
+            m_tick++;
+            flushCommands();
+            flushEvents();
+        }
+
+        // Observers are called with the batch of entities that got, lost or updated a comp_t whenever events
+        // are flushed, which updateSystems does after flushing commands. Pools don't record anything for
+        // events nobody observes
+        template<typename comp_t>
+        void onAdd(pool_observer_t observer) {
+            getOrCreatePool<comp_t>()->onAdd(std::move(observer));
+        }
+
+        template<typename comp_t>
+        void onRemove(pool_observer_t observer) {
+            getOrCreatePool<comp_t>()->onRemove(std::move(observer));
+        }
+
+        // Only for components that track changes
+        template<typename comp_t>
+        void onUpdate(pool_observer_t observer) {
+            getOrCreatePool<comp_t>()->onUpdate(std::move(observer));
+        }
+
+        void flushEvents() {
+            EMERALD_PROFILE_SPAN(m_profiler, "flushEvents");
+            std::apply([](auto&... pools) {
+                (pools.flushEvents(), ...);
+            }, m_pools);
+            for(auto& pool : m_components) {
+                if(pool) {
+                    pool->flushEvents();
+                }
             }
+            m_tick++;
+        }
+
+        // Writes the entity table and every registered pool, components of types the manager wasn't
+        // declared with aren't saved
+        void saveSnapshot(const std::string& path) const {
+            SnapshotWriter writer(path);
+            writeHeader(writer, snapshot_magic);
+            writer.write<uint64_t>(m_entities.size());
+            writer.write(m_entities.data(), m_entities.size() * sizeof(emerald_entity));
+            writer.write<uint64_t>(m_freeEntities.size());
+            writer.write(m_freeEntities.data(), m_freeEntities.size() * sizeof(emerald_id));
+            std::apply([&writer](auto&... pools) {
+                (pools.saveSnapshot(writer), ...);
+            }, m_pools);
         }
 
+        // Replaces every entity and component with the ones in a snapshot made by a manager with the same
+        // component types. The file is mapped and the pools are copied out of it a page at a time, pools
+        // of types the manager wasn't declared with are emptied and observers aren't told. A snapshot with the
+        // wrong header throws BadSnapshot before anything changes, one that doesn't hold together past it
+        // throws and leaves the manager without any entities
+        void loadSnapshot(const std::string& path) {
+            MappedFile file(path);
+            SnapshotReader reader(file.getData(), file.getSize());
+            readHeader(reader, snapshot_magic);
+            try {
+                auto entities = reader.read<uint64_t>();
+                if(entities > max_entities || entities > reader.getRemaining() / sizeof(emerald_entity)) {
+                    throw BadSnapshot("Snapshot entity table is truncated or too large");
+                }
+                m_entities.resize(entities);
+                reader.readInto(m_entities.data(), entities * sizeof(emerald_entity));
+                auto freeEntities = reader.read<uint64_t>();
+                if(freeEntities > entities) {
+                    throw BadSnapshot("Snapshot has more free entities than entities");
+                }
+                m_freeEntities.resize(freeEntities);
+                reader.readInto(m_freeEntities.data(), freeEntities * sizeof(emerald_id));
+                std::size_t dead = 0;
+                for(emerald_id index = 0; index < entities; index++) {
+                    if(entityIndex(m_entities[index]) != index && entityIndex(m_entities[index]) != dead_index) {
+                        throw BadSnapshot("Snapshot entity is in the wrong slot");
+                    }
+                    dead += entityIndex(m_entities[index]) == dead_index;
+                }
+                checkFreeEntities(m_freeEntities.data(), freeEntities, dead, [this, entities](const emerald_id index) {
+                    return index < entities && entityIndex(m_entities[index]) == dead_index;
+                });
+                m_entityCount = entities - freeEntities;
+                m_entityVersions.assign(entities, m_tick);
+                m_signatures.assign(entities, Signature());
+                m_hierarchy.clear();
+                std::apply([this, &reader](auto&... pools) {
+                    (pools.loadSnapshot(reader, m_entities), ...);
+                }, m_pools);
+            } catch(const BadSnapshot&) {
+                clearEntities();
+                throw;
+            }
+            for(auto& pool : m_components) {
+                if(pool) {
+                    pool->clear();
+                }
+            }
+        }
+
+        // Replaces delta with everything that changed after tick since: entities created or destroyed,
+        // removed components and components written to, and tags added or removed. Every registered component
+        // has to track changes or be a tag. Returns the tick to pass next time, anything changed after the call
+        // gets a later one
+        emerald_tick makeDelta(const emerald_tick since, std::vector<char>& delta) {
+            static_assert(((tracks_changes_v<registry_ts> || is_tag_v<registry_ts>) && ...), "Deltas need every registered component to track changes");
+            delta.clear();
+            SnapshotWriter writer(delta);
+            writeHeader(writer, delta_magic);
+            emerald_tick tick = m_tick;
+            writer.write(since);
+            writer.write(tick);
+            writer.write<uint64_t>(m_entities.size());
+            uint64_t changed = 0;
+            for(auto version : m_entityVersions) {
+                changed += version > since;
+            }
+            writer.write(changed);
+            for(emerald_id index = 0; index < m_entities.size(); index++) {
+                if(m_entityVersions[index] > since) {
+                    writer.write(index);
+                    writer.write(m_entities[index]);
+                }
+            }
+            if(changed > 0) {
+                writer.write<uint64_t>(m_freeEntities.size());
+                writer.write(m_freeEntities.data(), m_freeEntities.size() * sizeof(emerald_id));
+            }
+            std::apply([&writer, since](auto&... pools) {
+                (pools.saveDelta(writer, since), ...);
+            }, m_pools);
+            m_tick++;
+            return tick;
+        }
+
+        // Applies a delta from a manager with the same component types that this one is in sync with up to
+        // the delta's starting tick. Destroyed entities lose every component, and the tick the delta was
+        // made at is returned. A delta whose header or entities don't hold together throws BadSnapshot before
+        // anything changes, one whose components don't throws and leaves the manager without any entities
+        emerald_tick applyDelta(const char* data, const std::size_t size) {
+            static_assert(((tracks_changes_v<registry_ts> || is_tag_v<registry_ts>) && ...), "Deltas need every registered component to track changes");
+            SnapshotReader reader(data, size);
+            readHeader(reader, delta_magic);
+            reader.read<emerald_tick>();
+            auto tick = reader.read<emerald_tick>();
+            auto entities = std::max<uint64_t>(reader.read<uint64_t>(), m_entities.size());
+            auto changed = reader.read<uint64_t>();
+            if(entities > max_entities || changed > entities || changed > reader.getRemaining() / (sizeof(emerald_id) + sizeof(emerald_entity))) {
+                throw BadSnapshot("Delta entity table is truncated or too large");
+            }
+            // Slots past the end of the table are dead until the delta says otherwise
+            auto current = [this](const emerald_id index) {
+                return index < m_entities.size() ? m_entities[index] : makeEntity(dead_index, 0);
+            };
+            std::vector<std::pair<emerald_id, emerald_entity>> changes(changed);
+            std::size_t dead = entities - m_entityCount;
+            for(std::size_t i = 0; i < changed; i++) {
+                auto index = reader.read<emerald_id>();
+                auto id = reader.read<emerald_entity>();
+                if(index >= entities || (i > 0 && index <= changes[i - 1].first) || (entityIndex(id) != index && entityIndex(id) != dead_index)) {
+                    throw BadSnapshot("Delta entity is out of range, out of order or in the wrong slot");
+                }
+                dead = dead + (entityIndex(id) == dead_index) - (entityIndex(current(index)) == dead_index);
+                changes[i] = {index, id};
+            }
+            std::vector<emerald_id> freeEntities;
+            if(changed > 0) {
+                auto count = reader.read<uint64_t>();
+                if(count > reader.getRemaining() / sizeof(emerald_id)) {
+                    throw BadSnapshot("Delta free entities are truncated");
+                }
+                freeEntities.resize(count);
+                reader.readInto(freeEntities.data(), count * sizeof(emerald_id));
+                checkFreeEntities(freeEntities.data(), count, dead, [&changes, &current, entities](const emerald_id index) {
+                    auto change = std::lower_bound(changes.begin(), changes.end(), index, [](const auto& change, const emerald_id index) {
+                        return change.first < index;
+                    });
+                    return index < entities && entityIndex(change != changes.end() && change->first == index ? change->second : current(index)) == dead_index;
+                });
+            }
+            try {
+                if(entities > m_entities.size()) {
+                    m_entities.resize(entities, makeEntity(dead_index, 0));
+                    m_entityVersions.resize(entities, 0);
+                    m_signatures.resize(entities);
+                }
+                for(auto [index, id] : changes) {
+                    if(m_entities[index] != id && isEntityValid(m_entities[index])) {
+                        removeComponents(m_entities[index]);
+                        m_hierarchy.remove(m_entities[index]);
+                    }
+                    m_entities[index] = id;
+                    m_entityVersions[index] = m_tick;
+                }
+                if(changed > 0) {
+                    m_freeEntities.assign(freeEntities.begin(), freeEntities.end());
+                    m_entityCount = m_entities.size() - freeEntities.size();
+                }
+                std::apply([this, &reader](auto&... pools) {
+                    (pools.loadDelta(reader, m_entities), ...);
+                }, m_pools);
+            } catch(const BadSnapshot&) {
+                clearEntities();
+                throw;
+            }
+            return tick;
+        }
+
+        emerald_tick applyDelta(const std::vector<char>& delta) {
+            return applyDelta(delta.data(), delta.size());
+        }
+
+        // Component removals and added tags are kept for deltas until forgotten, deltas since tick or later
+        // still work
+        void forgetChanges(const emerald_tick tick) {
+            std::apply([tick](auto&... pools) {
+                (pools.forgetChanges(tick), ...);
+            }, m_pools);
+        }
+
+        // Mutable access to components that track changes is stamped with this
+        emerald_tick getTick() const {
+            return m_tick;
+        }
+
+        emerald_tick advanceTick() {
+            return ++m_tick;
+        }
+
+        template<typename comp_t>
+        PoolStats getPoolStats() const {
+            if(auto pool = getPool<comp_t>(); pool != nullptr) {
+                return pool->getStats();
+            }
+            return {};
+        }
+
+        // Stats of every pool added together
+        PoolStats getPoolStats() const {
+            PoolStats stats;
+            const_cast<EntityManager*>(this)->forEachPool([&stats](IBaseComponentPool& pool) {
+                stats += pool.getStats();
+                return true;
+            });
+            return stats;
+        }
+
+        // Moves components into the holes removals left and frees the pages that empties, a few hundred moves
+        // at a time until every pool is compact or budget runs out. Returns true once everything is compact,
+        // call it again next frame otherwise. Components move, so no locations, references or views into the
+        // pools should be held across it
+        bool compact(const std::chrono::microseconds budget = std::chrono::microseconds::max()) {
+            auto start = std::chrono::steady_clock::now();
+            return forEachPool([start, budget](IBaseComponentPool& pool) {
+                while(!pool.compact(compact_step)) {
+                    if(std::chrono::steady_clock::now() - start >= budget) {
+                        return false;
+                    }
+                }
+                return true;
+            });
+        }
+
+        // Compacts everything at once and gives back all the memory the pools and entity table can spare
+        void shrinkToFit() {
+            forEachPool([](IBaseComponentPool& pool) {
+                pool.shrinkToFit();
+                return true;
+            });
+            m_freeEntities.shrink_to_fit();
+        }
+
+        // Global state such as input or the clock, one value_t per manager kept outside the pools and found by
+        // index. Replaces the one there already
+        template<typename value_t, typename... args_t>
+        value_t& emplaceSingleton(args_t&&... args) {
+            auto singletonID = Singleton<value_t>::getSingletonID();
+            if(singletonID >= m_singletons.size()) {
+                m_singletons.resize(singletonID + 1);
+            }
+            m_singletons[singletonID] = std::make_unique<Singleton<value_t>>(std::forward<args_t>(args)...);
+            return static_cast<Singleton<value_t>&>(*m_singletons[singletonID]).get();
+        }
+
+        // Default constructs value_t the first time if it can, so singletons systems share across worker
+        // threads should be created before they run
+        template<typename value_t>
+        value_t& singleton() {
+            if(auto singletonID = Singleton<value_t>::getSingletonID(); singletonID < m_singletons.size() && m_singletons[singletonID]) {
+                return static_cast<Singleton<value_t>&>(*m_singletons[singletonID]).get();
+            }
+            if constexpr(std::is_default_constructible_v<value_t>) {
+                return emplaceSingleton<value_t>();
+            } else {
+                throw BadType("singleton hasn't been created");
+            }
+        }
+
+        template<typename value_t>
+        const value_t& singleton() const {
+            if(auto singletonID = Singleton<value_t>::getSingletonID(); singletonID < m_singletons.size() && m_singletons[singletonID]) {
+                return static_cast<const Singleton<value_t>&>(*m_singletons[singletonID]).get();
+            }
+            throw BadType("singleton const hasn't been created");
+        }
+
+        template<typename value_t>
+        bool hasSingleton() const {
+            auto singletonID = Singleton<value_t>::getSingletonID();
+            return singletonID < m_singletons.size() && m_singletons[singletonID] != nullptr;
+        }
+
+        // Structural changes made while mapping entities or components should go here instead of straight
+        // to the manager. Every worker thread gets its own buffer, so recording never needs a lock
+        command_buffer& getCommandBuffer() {
+            return *m_commandBuffers[m_threadPool ? m_threadPool->getCurrentWorker() : 0];
+        }
+
+        void flushCommands() {
+            EMERALD_PROFILE_SPAN(m_profiler, "flushCommands");
+            for(auto& buffer : m_commandBuffers) {
+                if(!buffer->isEmpty()) {
+                    buffer->flush(*this);
+                }
+            }
+        }
+
+        // 0 runs everything on the calling thread, pending commands are flushed first
+        void setWorkerCount(const std::size_t threads) {
+            flushCommands();
+            m_threadPool = threads > 0 ? std::make_unique<ThreadPool>(threads) : nullptr;
+            m_commandBuffers.resize(m_threadPool ? m_threadPool->getWorkerCount() : 1);
+            for(auto& buffer : m_commandBuffers) {
+                if(!buffer) {
+                    buffer = std::make_unique<command_buffer>();
+                }
+            }
+        }
+
+        ThreadPool* getThreadPool() {
+            return m_threadPool.get();
+        }
+
+        std::pmr::memory_resource* getResource() const {
+            return m_resource;
+        }
+
+#ifdef EMERALD_PROFILE
+        // Per system timings and the spans of every update, only there when EMERALD_PROFILE is defined
+        Profiler& getProfiler() {
+            return m_profiler;
+        }
+#endif
+
     private:
+        // Free slots in m_entities hold this index alongside the generation their next handle will use
+        static constexpr emerald_id dead_index = entity_index_mask;
+        static constexpr std::size_t compact_step = 256;
+
+        struct SystemEntry {
+            std::unique_ptr<IBaseSystem> system;
+            void (*update)(IBaseSystem&, EntityManager&);
+            SystemAccess access;
+            std::vector<std::size_t> dependents;
+            std::size_t dependencies;
+        };
+
+        // Registered pools first, stops as soon as func returns false and returns whether it never did
+        template<typename func_t>
+        bool forEachPool(func_t func) {
+            auto result = std::apply([&func](auto&... pools) {
+                return (func(pools) && ...);
+            }, m_pools);
+            for(std::size_t i = 0; result && i < m_components.size(); i++) {
+                if(m_components[i]) {
+                    result = func(*m_components[i]);
+                }
+            }
+            return result;
+        }
+
+        // Throws unless the free list names each of the dead slots exactly once, isDead(index) tells whether a slot
+        // is dead, out of range ones included
+        template<typename dead_t>
+        static void checkFreeEntities(const emerald_id* freeEntities, const std::size_t count, const std::size_t dead, dead_t isDead) {
+            if(count != dead) {
+                throw BadSnapshot("Free entity count doesn't match the dead entities");
+            }
+            Bitset seen;
+            for(std::size_t i = 0; i < count; i++) {
+                if(!isDead(freeEntities[i]) || seen.test(freeEntities[i])) {
+                    throw BadSnapshot("Free entity isn't dead or is listed twice");
+                }
+                seen.set(freeEntities[i]);
+            }
+        }
+
+        // Drops every entity and component without telling observers, for when loading goes wrong part way
+        void clearEntities() {
+            m_entities.clear();
+            m_freeEntities.clear();
+            m_entityVersions.clear();
+            m_signatures.clear();
+            m_entityCount = 0;
+            m_hierarchy.clear();
+            std::apply([](auto&... pools) {
+                (pools.clear(), ...);
+            }, m_pools);
+            for(auto& pool : m_components) {
+                if(pool) {
+                    pool->clear();
+                }
+            }
+        }
+
+        void removeComponents(const emerald_entity id) {
+            std::apply([id](auto&... pools) {
+                (pools.removeComponent(id), ...);
+            }, m_pools);
+            for(auto& pool : m_components) {
+                if(pool) {
+                    pool->removeComponent(id);
+                }
+            }
+        }
+
+        // Snapshots and deltas both start with the format and the registered component types
+        void writeHeader(SnapshotWriter& writer, const char (&magic)[8]) const {
+            writer.write(magic, sizeof(magic));
+            writer.write<uint32_t>(snapshot_version);
+            writer.write<uint32_t>(entity_index_bits);
+            writer.write<uint32_t>(sizeof...(registry_ts));
+            (writer.write(std::string(typeid(registry_ts).name())), ...);
+        }
+
+        void readHeader(SnapshotReader& reader, const char (&magic)[8]) const {
+            if(std::memcmp(reader.read(sizeof(magic)), magic, sizeof(magic)) != 0) {
+                throw BadSnapshot("Not a snapshot or delta of the expected kind");
+            }
+            if(reader.read<uint32_t>() != snapshot_version || reader.read<uint32_t>() != entity_index_bits) {
+                throw BadSnapshot("Snapshot version or entity size doesn't match");
+            }
+            if(reader.read<uint32_t>() != sizeof...(registry_ts) || ((reader.readString() != typeid(registry_ts).name()) || ...)) {
+                throw BadSnapshot("Snapshot component types don't match");
+            }
+        }
+
+        std::vector<emerald_entity> allocateEntities(const std::size_t amount) {
+            if(amount > m_freeEntities.size() && m_entities.size() + amount - m_freeEntities.size() > max_entities) {
+                throw BadID("createEntities entity limit reached");
+            }
+            std::vector<emerald_entity> ids(amount);
+            std::size_t i = 0;
+            for(; i < amount && m_freeEntities.size() > 0; i++) {
+                auto index = m_freeEntities.back();
+                m_freeEntities.pop_back();
+                m_entities[index] = makeEntity(index, entityGeneration(m_entities[index]));
+                m_entityVersions[index] = m_tick;
+                ids[i] = m_entities[index];
+            }
+            m_entities.reserve(m_entities.size() + amount - i);
+            m_entityVersions.resize(m_entities.size() + amount - i, m_tick);
+            m_signatures.resize(m_entities.size() + amount - i);
+            for(; i < amount; i++) {
+                emerald_id index = m_entities.size();
+                m_entities.push_back(makeEntity(index, 0));
+                ids[i] = m_entities[index];
+            }
+            m_entityCount += amount;
+            EMERALD_PROFILE_CHANGES(amount);
+            return ids;
+        }
+
+        const SystemEntry* findSystem(const emerald_id systemID) const {
+            if(systemID < m_systemLookup.size() && m_systemLookup[systemID] != invalid_id) {
+                return &m_systems[m_systemLookup[systemID]];
+            }
+            return nullptr;
+        }
+
+        SystemEntry* findSystem(const emerald_id systemID) {
+            return const_cast<SystemEntry*>(static_cast<const EntityManager*>(this)->findSystem(systemID));
+        }
+
+        template<typename lead_t, typename... comp_ts, typename func_t>
+        void parallelMapLead(const std::size_t grain, func_t func) {
+            auto lead = getPool<lead_t>();
+            auto pools = std::make_tuple(getPool<comp_ts>()...);
+            if(lead == nullptr || ((std::get<ComponentPool<comp_ts>*>(pools) == nullptr) || ...)) {
+                return;
+            }
+            // Decided on the calling thread, the workers don't know which system they're running for
+            const bool stamps[] = {stampsWrites<lead_t>(), stampsWrites<comp_ts>()...};
+            auto access = [](auto* pool, const emerald_id location, const bool stamp) -> auto& {
+                return stamp ? pool->writeSlot(location) : pool->getSlot(location);
+            };
+            parallelFor(m_threadPool.get(), lead->getTop(), alignGrain<lead_t>(grain), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+                EMERALD_PROFILE_VISITS(end - begin);
+                for(auto loc = begin; loc < end; loc++) {
+                    auto id = lead->getEntity(loc);
+                    if(id != invalid_entity && (std::get<ComponentPool<comp_ts>*>(pools)->hasComponent(id) && ...)) {
+                        func(worker, access(lead, loc, stamps[0]), access(std::get<ComponentPool<comp_ts>*>(pools), std::get<ComponentPool<comp_ts>*>(pools)->getLocation(id), stamps[1 + index_of<comp_ts, comp_ts...>::value])...);
+                    }
+                }
+            });
+        }
+
+        // Every system is submitted once all of the earlier systems it conflicts with have finished
+        void runSystem(const std::size_t index) {
+            auto& entry = m_systems[index];
+            entry.system->beginUpdate(++m_tick);
+#ifdef EMERALD_PROFILE
+            ProfileCounters counters;
+            auto start = Profiler::now();
+            {
+                ProfileScope scope(counters);
+                SystemWritesScope writes(entry.access.declared ? &entry.access.writes : nullptr);
+                entry.update(*entry.system, *this);
+            }
+            m_profiler.recordSystem(index, start, Profiler::now(), counters.visited, counters.changes);
+#else
+            SystemWritesScope writes(entry.access.declared ? &entry.access.writes : nullptr);
+            entry.update(*entry.system, *this);
+#endif
+        }
+
+        void runSystemGraph() {
+            std::vector<std::atomic<std::size_t>> remaining(m_systems.size());
+            std::atomic<std::size_t> finished(0);
+            std::exception_ptr error;
+            std::mutex errorMutex;
+            std::function<void(std::size_t)> run = [&](std::size_t index) {
+                auto& entry = m_systems[index];
+                try {
+                    runSystem(index);
+                } catch(...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if(!error) {
+                        error = std::current_exception();
+                    }
+                }
+                for(auto dependent : entry.dependents) {
+                    if(--remaining[dependent] == 0) {
+                        m_threadPool->submit([&run, dependent] {
+                            run(dependent);
+                        });
+                    }
+                }
+                finished++;
+            };
+            for(std::size_t i = 0; i < m_systems.size(); i++) {
+                remaining[i] = m_systems[i].dependencies;
+            }
+            for(std::size_t i = 0; i < m_systems.size(); i++) {
+                if(m_systems[i].dependencies == 0) {
+                    m_threadPool->submit([&run, i] {
+                        run(i);
+                    });
+                }
+            }
+            m_threadPool->waitUntil([&finished, this] {
+                return finished == m_systems.size();
+            });
+            if(error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        template<typename comp_t>
+        ComponentPool<comp_t>* getPool() {
+            if constexpr(is_registered<comp_t>) {
+                return &std::get<index_of<comp_t, registry_ts...>::value>(m_pools);
+            } else {
+                auto compID = getComponentID<comp_t>();
+                if(compID < m_components.size()) {
+                    return static_cast<ComponentPool<comp_t>*>(m_components[compID].get());
+                }
+                return nullptr;
+            }
+        }
+
+        template<typename comp_t>
+        const ComponentPool<comp_t>* getPool() const {
+            return const_cast<EntityManager*>(this)->getPool<comp_t>();
+        }
+
+        // Sets the signature bits of comp_ts, false if one of them has no pool yet so nothing can have it
+        template<typename... comp_ts>
+        bool makeMask(Signature& mask) const {
+            return (addToMask<std::remove_const_t<comp_ts>>(mask) && ...);
+        }
+
+        template<typename comp_t>
+        bool addToMask(Signature& mask) const {
+            if constexpr(is_registered<comp_t>) {
+                mask.set(index_of<comp_t, registry_ts...>::value);
+                return true;
+            } else {
+                auto compID = getComponentID<comp_t>();
+                if(compID < m_componentBits.size() && m_componentBits[compID] != invalid_id) {
+                    mask.set(m_componentBits[compID]);
+                    return true;
+                }
+                return false;
+            }
+        }
+
+        template<typename comp_t>
+        ComponentPool<comp_t>* getOrCreatePool() {
+            if constexpr(is_registered<comp_t>) {
+                return getPool<comp_t>();
+            } else {
+                auto compID = getComponentID<comp_t>();
+                if(compID >= m_components.size()) {
+                    m_components.resize(compID + 1);
+                }
+                if(!m_components[compID]) {
+                    if(m_nextComponentBit >= Signature::max_components) {
+                        throw BadComponent("More component types than EMERALD_MAX_COMPONENTS");
+                    }
+                    auto pool = std::make_unique<ComponentPool<comp_t>>(m_resource);
+                    attachPool(*pool, m_nextComponentBit);
+                    m_componentBits.resize(m_components.size(), invalid_id);
+                    m_componentBits[compID] = m_nextComponentBit++;
+                    m_components[compID] = std::move(pool);
+                }
+                return static_cast<ComponentPool<comp_t>*>(m_components[compID].get());
+            }
+        }
+
+        // Pools stamp with the manager's tick and keep bit of every entity's signature, tags are nothing but that
+        // bit so they find their owners in the entity table too
+        template<typename comp_t>
+        void attachPool(ComponentPool<comp_t>& pool, const std::size_t bit) {
+            pool.setTickSource(&m_tick);
+            pool.setSignatures(&m_signatures, bit);
+            if constexpr(is_tag_v<comp_t>) {
+                pool.setEntities(&m_entities);
+            }
+        }
+
+        std::pmr::memory_resource* m_resource;
         std::size_t m_entityCount;
-        std::unordered_map<emerald_id, std::vector<emerald_long>> m_entities;
-        std::unordered_map<emerald_id, std::unique_ptr<IBaseSystem>> m_systems;
-        std::unordered_map<emerald_id, std::unique_ptr<IBaseComponentPool>> m_components;
+        std::atomic<emerald_tick> m_tick;
+        std::pmr::vector<emerald_entity> m_entities;
+        std::pmr::vector<emerald_id> m_freeEntities;
+        std::pmr::vector<emerald_tick> m_entityVersions;
+        // Which components every entity in m_entities has
+        std::pmr::vector<Signature> m_signatures;
+        Hierarchy m_hierarchy;
+        std::vector<SystemEntry> m_systems;
+        std::vector<emerald_id> m_systemLookup;
+        std::unique_ptr<ThreadPool> m_threadPool;
+        std::vector<std::unique_ptr<command_buffer>> m_commandBuffers;
+        std::tuple<ComponentPool<registry_ts>...> m_pools;
+        std::vector<std::unique_ptr<IBaseComponentPool>> m_components;
+        // Signature bit of every pool in m_components, they come after the registered ones
+        std::vector<emerald_id> m_componentBits;
+        std::size_t m_nextComponentBit = sizeof...(registry_ts);
+        // After the pools so groups let go of them first
+        std::vector<std::unique_ptr<IBaseGroup>> m_groups;
+        std::vector<std::unique_ptr<ISingleton>> m_singletons;
+#ifdef EMERALD_PROFILE
+        Profiler m_profiler;
+#endif
     };
 
 };
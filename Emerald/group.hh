@@ -0,0 +1,127 @@
+#ifndef _EMERALD_GROUP_H
+#define _EMERALD_GROUP_H
+
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Util/types.hh"
+#include "Util/exceptions.hh"
+#include "Util/profiler.hh"
+#include "component.hh"
+
+namespace Emerald {
+
+    // Owns the packed pools of comp_ts and keeps the entities that have all of them at the front of every
+    // pool in the same order, so the first getSize() locations line up across the pools. An entity is swapped
+    // into the group when it gets its last component and out of it before it loses one
+    template<typename... comp_ts>
+    class Group : public IBaseGroup {
+    public:
+        static_assert(sizeof...(comp_ts) > 1, "A group needs at least two component types");
+        static_assert((!is_tag_v<comp_ts> && ...), "Tags have no components for a group to own");
+
+        static emerald_id getGroupID() {
+            static emerald_id groupID = groupIDCounter++;
+            return groupID;
+        }
+
+        Group(ComponentPool<comp_ts>*... pools)
+        : m_pools(pools...)
+        , m_size(0) {
+            if(((pools->getGroup() != nullptr) || ...)) {
+                throw BadComponent("Component is already owned by another group");
+            }
+            (pools->setGroup(this), ...);
+            rebuild();
+        }
+
+        Group(const Group&) = delete;
+        Group& operator=(const Group&) = delete;
+
+        ~Group() {
+            std::apply([](auto*... pools) {
+                (pools->setGroup(nullptr), ...);
+            }, m_pools);
+        }
+
+        void onCreate(const emerald_entity entID) override {
+            if(auto location = lead()->getLocation(entID); location != invalid_id && location >= m_size && hasAll(entID)) {
+                swapTo(entID, m_size++);
+            }
+        }
+
+        void onDelete(const emerald_entity entID) override {
+            if(auto location = lead()->getLocation(entID); location != invalid_id && location < m_size) {
+                swapTo(entID, --m_size);
+            }
+        }
+
+        // Gathers every entity that has all the components to the front again
+        void rebuild() override {
+            m_size = 0;
+            for(emerald_id location = 0; location < lead()->getSize(); location++) {
+                if(auto entID = lead()->getEntity(location); hasAll(entID)) {
+                    swapTo(entID, m_size++);
+                }
+            }
+        }
+
+        std::size_t getSize() const {
+            return m_size;
+        }
+
+        emerald_entity getEntity(const emerald_id index) const {
+            return lead()->getEntity(index);
+        }
+
+        // func is called with each entity and its components, walking every pool front to back together.
+        // Components the running system declared it writes are stamped
+        template<typename func_t>
+        void map(func_t func) {
+            EMERALD_PROFILE_VISITS(m_size);
+            mapPools(func, std::index_sequence_for<comp_ts...>());
+        }
+
+        // Orders the group by compare, which takes two entities or two of the first component type
+        template<typename compare_t>
+        void sort(compare_t compare) {
+            auto order = lead()->sortedOrder(compare, m_size);
+            std::apply([&order](auto*... pools) {
+                (pools->reorder(order), ...);
+            }, m_pools);
+        }
+
+    private:
+        using lead_t = std::tuple_element_t<0, std::tuple<comp_ts...>>;
+
+        ComponentPool<lead_t>* lead() const {
+            return std::get<0>(m_pools);
+        }
+
+        bool hasAll(const emerald_entity entID) const {
+            return std::apply([entID](auto*... pools) {
+                return (pools->hasComponent(entID) && ...);
+            }, m_pools);
+        }
+
+        void swapTo(const emerald_entity entID, const emerald_id location) {
+            std::apply([entID, location](auto*... pools) {
+                (pools->swapLocations(pools->getLocation(entID), location), ...);
+            }, m_pools);
+        }
+
+        template<typename func_t, std::size_t... Is>
+        void mapPools(func_t& func, std::index_sequence<Is...>) {
+            const bool stamps[] = {stampsWrites<comp_ts>()...};
+            for(emerald_id location = 0; location < m_size; location++) {
+                func(lead()->getEntity(location), (stamps[Is] ? std::get<Is>(m_pools)->writeSlot(location) : std::get<Is>(m_pools)->getSlot(location))...);
+            }
+        }
+
+        std::tuple<ComponentPool<comp_ts>*...> m_pools;
+        std::size_t m_size;
+    };
+
+};
+
+#endif // _EMERALD_GROUP_H
@@ -0,0 +1,303 @@
+#ifndef _EMERALD_HIERARCHY_H
+#define _EMERALD_HIERARCHY_H
+
+#include <vector>
+#include <memory_resource>
+#include <limits>
+#include <utility>
+#include "Util/types.hh"
+#include "Util/exceptions.hh"
+#include "Util/profiler.hh"
+#include "component.hh"
+
+namespace Emerald {
+
+    // Parent and child links between entities, with every entity in the hierarchy also kept in an array where
+    // parents always come before their children. Adding a node or moving one under a parent that's already
+    // ahead of it keeps the array as it is, moving one under a parent behind it moves just its subtree to the
+    // end. Removing a node makes its children roots and leaves a hole, the array is compacted in order when
+    // holes outnumber nodes
+    class Hierarchy {
+    public:
+        Hierarchy(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_nodes(resource)
+        , m_order(resource)
+        , m_parents(resource)
+        , m_locations(resource)
+        , m_firstRoot(invalid_entity)
+        , m_size(0) {}
+
+        Hierarchy(const Hierarchy&) = delete;
+        Hierarchy& operator=(const Hierarchy&) = delete;
+
+        // parent is invalid_entity to make child a root, either one is added if it isn't in the hierarchy yet
+        void setParent(const emerald_entity child, const emerald_entity parent) {
+            if(parent != invalid_entity) {
+                if(entityIndex(parent) == entityIndex(child) || isAncestor(child, parent)) {
+                    throw BadID("setParent would make an entity its own ancestor");
+                }
+                if(!contains(parent)) {
+                    add(parent, invalid_entity);
+                }
+            }
+            if(!contains(child)) {
+                add(child, parent);
+                return;
+            }
+            unlink(child);
+            link(child, parent);
+            auto position = node(child).position;
+            if(parent == invalid_entity) {
+                m_parents[position] = invalid_id;
+            } else if(node(parent).position < position) {
+                m_parents[position] = node(parent).position;
+            } else {
+                moveSubtree(child);
+            }
+        }
+
+        void remove(const emerald_entity entID) {
+            if(!contains(entID)) {
+                return;
+            }
+            while(node(entID).firstChild != invalid_entity) {
+                auto child = node(entID).firstChild;
+                unlink(child);
+                link(child, invalid_entity);
+                m_parents[node(child).position] = invalid_id;
+            }
+            unlink(entID);
+            m_order[node(entID).position] = invalid_entity;
+            m_parents[node(entID).position] = invalid_id;
+            node(entID) = Node();
+            m_size--;
+        }
+
+        void clear() {
+            m_nodes.clear();
+            m_order.clear();
+            m_parents.clear();
+            m_firstRoot = invalid_entity;
+            m_size = 0;
+        }
+
+        bool contains(const emerald_entity entID) const {
+            return entityIndex(entID) < m_nodes.size() && m_nodes[entityIndex(entID)].self == entID;
+        }
+
+        // invalid_entity for roots and entities that aren't in the hierarchy
+        emerald_entity getParent(const emerald_entity entID) const {
+            return contains(entID) ? node(entID).parent : invalid_entity;
+        }
+
+        template<typename func_t>
+        void mapChildren(const emerald_entity entID, func_t func) const {
+            if(contains(entID)) {
+                for(auto child = node(entID).firstChild; child != invalid_entity; child = node(child).nextSibling) {
+                    func(child);
+                }
+            }
+        }
+
+        std::size_t getSize() const {
+            return m_size;
+        }
+
+        // func is called with every entity and its parent, invalid_entity for roots, parents first
+        template<typename func_t>
+        void map(func_t func) {
+            update();
+            EMERALD_PROFILE_VISITS(m_size);
+            for(emerald_id position = 0; position < m_order.size(); position++) {
+                if(m_order[position] != invalid_entity) {
+                    func(m_order[position], m_parents[position] != invalid_id ? m_order[m_parents[position]] : invalid_entity);
+                }
+            }
+        }
+
+        // Puts the components of entities in the hierarchy at the front of pool in hierarchy order, then calls
+        // func with the component of every entity whose parent has one too and the parent's, parents first.
+        // Both pools and the hierarchy are walked front to back, and the pool is only reordered when it was
+        // changed since the last time. Components move, so nothing should hold their locations across it
+        template<typename comp_t, typename func_t>
+        void propagate(ComponentPool<comp_t>& pool, func_t func) {
+            static_assert(!is_tag_v<comp_t>, "Tags have nothing to propagate");
+            if(pool.getGroup() != nullptr) {
+                throw BadComponent("Components owned by a group can't follow a hierarchy");
+            }
+            update();
+            if(!align(pool)) {
+                while(!pool.compact(std::numeric_limits<std::size_t>::max())) {}
+                reorder(pool);
+            }
+            EMERALD_PROFILE_VISITS(m_size);
+            const auto& parents = pool;
+            for(emerald_id position = 0; position < m_order.size(); position++) {
+                if(auto parent = m_parents[position]; parent != invalid_id && m_locations[position] != invalid_id && m_locations[parent] != invalid_id) {
+                    func(pool.writeSlot(m_locations[position]), parents.getSlot(m_locations[parent]));
+                }
+            }
+        }
+
+    private:
+        struct Node {
+            emerald_entity self = invalid_entity;
+            emerald_entity parent = invalid_entity;
+            emerald_entity firstChild = invalid_entity;
+            emerald_entity nextSibling = invalid_entity;
+            emerald_entity prevSibling = invalid_entity;
+            emerald_id position = invalid_id;
+        };
+
+        Node& node(const emerald_entity entID) {
+            return m_nodes[entityIndex(entID)];
+        }
+
+        const Node& node(const emerald_entity entID) const {
+            return m_nodes[entityIndex(entID)];
+        }
+
+        void add(const emerald_entity entID, const emerald_entity parent) {
+            if(entityIndex(entID) >= m_nodes.size()) {
+                m_nodes.resize(entityIndex(entID) + 1);
+            }
+            node(entID).self = entID;
+            link(entID, parent);
+            m_size++;
+            append(entID, parent != invalid_entity ? node(parent).position : invalid_id);
+        }
+
+        void append(const emerald_entity entID, const emerald_id parentPosition) {
+            node(entID).position = m_order.size();
+            m_order.push_back(entID);
+            m_parents.push_back(parentPosition);
+        }
+
+        // Moves entID and everything below it to the end of the order, leaving holes where they were
+        void moveSubtree(const emerald_entity entID) {
+            auto begin = m_order.size();
+            moveToEnd(entID, node(node(entID).parent).position);
+            for(auto position = begin; position < m_order.size(); position++) {
+                for(auto child = node(m_order[position]).firstChild; child != invalid_entity; child = node(child).nextSibling) {
+                    moveToEnd(child, position);
+                }
+            }
+        }
+
+        void moveToEnd(const emerald_entity entID, const emerald_id parentPosition) {
+            m_order[node(entID).position] = invalid_entity;
+            m_parents[node(entID).position] = invalid_id;
+            append(entID, parentPosition);
+        }
+
+        // Roots are siblings of each other with no parent
+        void link(const emerald_entity entID, const emerald_entity parent) {
+            auto& first = parent != invalid_entity ? node(parent).firstChild : m_firstRoot;
+            node(entID).parent = parent;
+            node(entID).prevSibling = invalid_entity;
+            node(entID).nextSibling = first;
+            if(first != invalid_entity) {
+                node(first).prevSibling = entID;
+            }
+            first = entID;
+        }
+
+        void unlink(const emerald_entity entID) {
+            auto& current = node(entID);
+            if(current.prevSibling != invalid_entity) {
+                node(current.prevSibling).nextSibling = current.nextSibling;
+            } else if(current.parent != invalid_entity) {
+                node(current.parent).firstChild = current.nextSibling;
+            } else {
+                m_firstRoot = current.nextSibling;
+            }
+            if(current.nextSibling != invalid_entity) {
+                node(current.nextSibling).prevSibling = current.prevSibling;
+            }
+            current.parent = invalid_entity;
+            current.prevSibling = invalid_entity;
+            current.nextSibling = invalid_entity;
+        }
+
+        bool isAncestor(const emerald_entity ancestor, emerald_entity entID) const {
+            while(contains(entID) && node(entID).parent != invalid_entity) {
+                entID = node(entID).parent;
+                if(entID == ancestor) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Closes the holes removals and moved subtrees left once they outnumber the nodes, keeping the order
+        void update() {
+            if(m_order.size() - m_size <= m_size) {
+                return;
+            }
+            std::vector<emerald_id> positions(m_order.size(), invalid_id);
+            emerald_id next = 0;
+            for(emerald_id position = 0; position < m_order.size(); position++) {
+                if(auto entID = m_order[position]; entID != invalid_entity) {
+                    positions[position] = next;
+                    node(entID).position = next;
+                    m_order[next] = entID;
+                    m_parents[next] = m_parents[position] != invalid_id ? positions[m_parents[position]] : invalid_id;
+                    next++;
+                }
+            }
+            m_order.resize(next);
+            m_parents.resize(next);
+        }
+
+        // Finds where every entity's component would be with the pool in hierarchy order, true if it already is
+        template<typename comp_t>
+        bool align(const ComponentPool<comp_t>& pool) {
+            m_locations.resize(m_order.size());
+            auto aligned = true;
+            emerald_id next = 0;
+            for(emerald_id position = 0; position < m_order.size(); position++) {
+                if(auto location = m_order[position] != invalid_entity ? pool.getLocation(m_order[position]) : invalid_id; location != invalid_id) {
+                    aligned = aligned && location == next;
+                    m_locations[position] = next++;
+                } else {
+                    m_locations[position] = invalid_id;
+                }
+            }
+            return aligned;
+        }
+
+        // The pool has no holes, components of entities outside the hierarchy keep their order behind the rest
+        template<typename comp_t>
+        void reorder(ComponentPool<comp_t>& pool) {
+            std::vector<emerald_id> order;
+            order.reserve(pool.getSize());
+            std::vector<bool> placed(pool.getSize(), false);
+            for(auto entID : m_order) {
+                if(auto location = entID != invalid_entity ? pool.getLocation(entID) : invalid_id; location != invalid_id) {
+                    order.push_back(location);
+                    placed[location] = true;
+                }
+            }
+            for(emerald_id location = 0; location < placed.size(); location++) {
+                if(!placed[location]) {
+                    order.push_back(location);
+                }
+            }
+            pool.reorder(std::move(order));
+        }
+
+        // Indexed by entity index
+        std::pmr::vector<Node> m_nodes;
+        // invalid_entity marks a hole
+        std::pmr::vector<emerald_entity> m_order;
+        // Position of every node's parent in m_order
+        std::pmr::vector<emerald_id> m_parents;
+        // Location in the pool being propagated of every node's component
+        std::pmr::vector<emerald_id> m_locations;
+        emerald_entity m_firstRoot;
+        std::size_t m_size;
+    };
+
+};
+
+#endif // _EMERALD_HIERARCHY_H
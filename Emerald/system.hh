@@ -1,23 +1,169 @@
 #ifndef _SYSTEMS_H
 #define _SYSTEMS_H
 
-#include <set>
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
 
 #include "Util/types.hh"
+#include "Util/meta.hh"
+#include "Util/bitset.hh"
+#include "Util/signature.hh"
+#include "Util/profiler.hh"
+#include "component.hh"
 
 namespace Emerald {
 
-    class EntityManager;
+    template<typename... comp_ts>
+    struct Reads {};
+
+    template<typename... comp_ts>
+    struct Writes {};
+
+    // The component ids a system reads and writes. Systems that don't declare their access conflict
+    // with every other system, so they never run alongside one
+    struct SystemAccess {
+        std::vector<emerald_id> reads;
+        std::vector<emerald_id> writes;
+        bool declared = false;
+
+        bool conflictsWith(const SystemAccess& other) const {
+            if(!declared || !other.declared) {
+                return true;
+            }
+            auto overlaps = [](const std::vector<emerald_id>& a, const std::vector<emerald_id>& b) {
+                return std::any_of(a.begin(), a.end(), [&b](emerald_id id) {
+                    return std::find(b.begin(), b.end(), id) != b.end();
+                });
+            };
+            return overlaps(writes, other.writes) || overlaps(writes, other.reads) || overlaps(reads, other.writes);
+        }
+    };
+
+    template<typename... comp_ts>
+    void addSystemAccess(SystemAccess& access, Reads<comp_ts...>) {
+        (access.reads.push_back(getComponentID<comp_ts>()), ...);
+        access.declared = true;
+    }
+
+    template<typename... comp_ts>
+    void addSystemAccess(SystemAccess& access, Writes<comp_ts...>) {
+        (access.writes.push_back(getComponentID<comp_ts>()), ...);
+        access.declared = true;
+    }
+
+    template<typename... comp_ts, typename func_t>
+    void forEachSystemComponent(Reads<comp_ts...>, func_t& func) {
+        (func(type_tag<comp_ts>{}), ...);
+    }
+
+    template<typename... comp_ts, typename func_t>
+    void forEachSystemComponent(Writes<comp_ts...>, func_t& func) {
+        (func(type_tag<comp_ts>{}), ...);
+    }
 
+    // The entities that have every component a system reads or writes, as a bitset over entity indices the
+    // pools keep up to date when components are added and removed. Mapping it walks the set bits, so members
+    // come in index order without probing a pool
+    class Membership : public IBaseGroup {
+    public:
+        Membership()
+        : m_entities(nullptr)
+        , m_signatures(nullptr)
+        , m_size(0) {}
+
+        // The manager attaches every system it registers with its entity table, the signatures alongside it
+        // and the bits of the system's components
+        void attach(const std::pmr::vector<emerald_entity>* entities, const std::pmr::vector<Signature>* signatures, const Signature& mask) {
+            m_entities = entities;
+            m_signatures = signatures;
+            m_mask = mask;
+            rebuild();
+        }
+
+        void onCreate(const emerald_entity entID) override {
+            if(auto index = entityIndex(entID); !m_members.test(index) && hasAll(entID)) {
+                m_members.set(index);
+                m_size++;
+            }
+        }
+
+        void onDelete(const emerald_entity entID) override {
+            if(auto index = entityIndex(entID); m_members.test(index)) {
+                m_members.reset(index);
+                m_size--;
+            }
+        }
+
+        void rebuild() override {
+            m_members.clear();
+            m_size = 0;
+            if(m_signatures == nullptr || m_mask.none()) {
+                return;
+            }
+            for(std::size_t begin = 0; begin < m_signatures->size(); begin += Bitset::word_bits) {
+                auto hits = matchSignatures(m_signatures->data() + begin, std::min(Bitset::word_bits, m_signatures->size() - begin), m_mask);
+                for(; hits != 0; hits &= hits - 1) {
+                    m_members.set(begin + countTrailingZeros(hits));
+                    m_size++;
+                }
+            }
+        }
+
+        bool contains(const emerald_entity entID) const {
+            return m_members.test(entityIndex(entID)) && (*m_entities)[entityIndex(entID)] == entID;
+        }
+
+        std::size_t getSize() const {
+            return m_size;
+        }
+
+        template<typename func_t>
+        void map(func_t func) const {
+            EMERALD_PROFILE_VISITS(m_size);
+            for(auto index = m_members.findNext(0); index != Bitset::npos; index = m_members.findNext(index + 1)) {
+                func((*m_entities)[index]);
+            }
+        }
+
+    private:
+        bool hasAll(const emerald_entity entID) const {
+            return !m_mask.none() && (*m_signatures)[entityIndex(entID)].contains(m_mask);
+        }
+
+        const std::pmr::vector<emerald_entity>* m_entities;
+        const std::pmr::vector<Signature>* m_signatures;
+        Signature m_mask;
+        Bitset m_members;
+        std::size_t m_size;
+    };
+
+    // Systems are updated through their own update(entity_manager_t&) which the EntityManager
+    // resolves when the system is registered
     class IBaseSystem {
     public:
-        virtual void update(EntityManager&) = 0;
+        virtual ~IBaseSystem() = default;
+
+        // Tick the previous update started at, views changedSince it give what changed since this system last ran
+        emerald_tick getLastTick() const {
+            return m_lastTick;
+        }
+
+        // The manager calls this with a new tick right before every update
+        void beginUpdate(const emerald_tick tick) {
+            m_lastTick = m_currentTick;
+            m_currentTick = tick;
+        }
 
     protected:
         inline static emerald_id systemIdCounter = 0;
+
+    private:
+        emerald_tick m_lastTick = 0;
+        emerald_tick m_currentTick = 0;
     };
 
-    template<typename system_t>
+    template<typename system_t, typename... access_ts>
     class ISystem : public IBaseSystem {
     public:
         static emerald_id getSystemID() {
@@ -25,27 +171,41 @@ namespace Emerald {
             return systemId;
         }
 
+        static SystemAccess getAccess() {
+            SystemAccess access;
+            (addSystemAccess(access, access_ts{}), ...);
+            return access;
+        }
+
+        // Calls func with a type_tag of every component the system reads or writes
+        template<typename func_t>
+        static void forEachComponent([[maybe_unused]] func_t func) {
+            (forEachSystemComponent(access_ts{}, func), ...);
+        }
+
         ISystem() = default;
         virtual ~ISystem() {}
 
         ISystem(const ISystem&) = delete;
 
-        ISystem(ISystem<system_t>&& system)
+        ISystem(ISystem&& system)
         : m_entities(std::move(system.m_entities)) {}
 
         ISystem& operator=(const ISystem&) = delete;
         ISystem& operator=(ISystem&& system) = delete;
 
-        void subscribe(emerald_id entityID) {
-            m_entities.insert(entityID);
+        // Every entity that has all the components the system reads and writes, kept by the manager. Systems
+        // that don't declare their access have no members
+        Membership& getEntities() {
+            return m_entities;
         }
 
-        void update(EntityManager& entMan) {
-            static_cast<system_t*>(this)->update(entMan);
+        const Membership& getEntities() const {
+            return m_entities;
         }
 
     protected:
-        std::set<emerald_id> m_entities;
+        Membership m_entities;
     };
 
     template<typename system_t>
@@ -0,0 +1,197 @@
+#ifndef _EMERALD_VIEW_H
+#define _EMERALD_VIEW_H
+
+#include <tuple>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include "Util/types.hh"
+#include "Util/profiler.hh"
+#include "component.hh"
+
+namespace Emerald {
+
+    // Joins the pools of comp_ts. The smallest pool leads the iteration and every one of its entities
+    // is looked up in the others, entities missing any of the components are skipped. Components of
+    // const types are only read, so they don't count as changed, and neither do the ones the system running
+    // when the view was made didn't declare it writes
+    template<typename... comp_ts>
+    class View {
+    private:
+        template<typename comp_t>
+        using pool_t = ComponentPool<std::remove_const_t<comp_t>>;
+
+        typedef std::tuple<pool_t<comp_ts>*...> pools_t;
+        typedef std::index_sequence_for<comp_ts...> indices_t;
+        typedef std::array<emerald_id, sizeof...(comp_ts)> locations_t;
+
+    public:
+        typedef std::tuple<emerald_entity, comp_ts&...> value_t;
+
+        class Iter {
+        public:
+            Iter(const View* view, const emerald_id loc)
+            : m_view(view)
+            , m_loc(loc) {
+                skip();
+            }
+
+            bool operator==(const Iter& other) const {
+                return m_loc == other.m_loc;
+            }
+
+            bool operator!=(const Iter& other) const {
+                return m_loc != other.m_loc;
+            }
+
+            Iter& operator++() {
+                m_loc++;
+                skip();
+                return *this;
+            }
+
+            Iter operator++(int) {
+                Iter tmp(*this);
+                operator++();
+                return tmp;
+            }
+
+            value_t operator*() const {
+                return m_view->get(m_loc, m_locs, indices_t());
+            }
+
+        private:
+            void skip() {
+                while(m_loc < m_view->m_leadSize && !m_view->locate(m_loc, m_locs, indices_t())) {
+                    m_loc++;
+                }
+            }
+
+            const View* m_view;
+            emerald_id m_loc;
+            locations_t m_locs;
+        };
+
+        View(pool_t<comp_ts>*... pools)
+        : m_pools(pools...)
+        , m_lead(0)
+        , m_leadSize(0)
+        , m_since(0)
+        , m_filtered(false)
+        , m_stamps{(!std::is_const<comp_ts>::value && stampsWrites<std::remove_const_t<comp_ts>>())...} {
+            if(((pools != nullptr) && ...)) {
+                findLead(indices_t());
+            }
+        }
+
+        Iter begin() const {
+            EMERALD_PROFILE_VISITS(m_leadSize);
+            return Iter(this, 0);
+        }
+
+        Iter end() const {
+            return Iter(this, m_leadSize);
+        }
+
+        // Upper bound on the number of entities in the view, the size of the smallest pool including its holes
+        std::size_t getSizeHint() const {
+            return m_leadSize;
+        }
+
+        // func is called with each entity and its components, the loop is instantiated once per
+        // possible lead so the lead's components are read straight from its pool
+        template<typename func_t>
+        void map(func_t func) const {
+            EMERALD_PROFILE_VISITS(m_leadSize);
+            if(m_leadSize > 0) {
+                mapFromLead(func, indices_t());
+            }
+        }
+
+        // Narrows the view to entities with a change tracked component that was written to after tick
+        View changedSince(const emerald_tick tick) const {
+            static_assert((tracks_changes_v<std::remove_const_t<comp_ts>> || ...), "changedSince needs a component that tracks changes");
+            View view(*this);
+            view.m_since = tick;
+            view.m_filtered = true;
+            return view;
+        }
+
+    private:
+        template<std::size_t... Is>
+        void findLead(std::index_sequence<Is...>) {
+            std::size_t sizes[] = {std::get<Is>(m_pools)->getTop()...};
+            for(std::size_t i = 1; i < sizeof...(Is); i++) {
+                if(sizes[i] < sizes[m_lead]) {
+                    m_lead = i;
+                }
+            }
+            m_leadSize = sizes[m_lead];
+        }
+
+        template<typename func_t, std::size_t... Is>
+        void mapFromLead(func_t& func, std::index_sequence<Is...> indices) const {
+            ((m_lead == Is ? mapFrom<Is>(func, indices) : void()), ...);
+        }
+
+        template<std::size_t lead_i, typename func_t, std::size_t... Is>
+        void mapFrom(func_t& func, std::index_sequence<Is...>) const {
+            auto lead = std::get<lead_i>(m_pools);
+            locations_t locs;
+            for(emerald_id loc = 0; loc < m_leadSize; loc++) {
+                auto id = lead->getEntity(loc);
+                if(id != invalid_entity && (((locs[Is] = (Is == lead_i ? loc : std::get<Is>(m_pools)->getLocation(id))) != invalid_id) && ...)) {
+                    if(!m_filtered || changed(locs, std::index_sequence<Is...>())) {
+                        func(id, getSlot<Is>(locs[Is])...);
+                    }
+                }
+            }
+        }
+
+        // Finds every component of the lead's entity at loc, false if the slot is empty or one is missing
+        template<std::size_t... Is>
+        bool locate(const emerald_id loc, locations_t& locs, std::index_sequence<Is...>) const {
+            auto id = getLeadEntity(loc, std::index_sequence<Is...>());
+            return id != invalid_entity && (((locs[Is] = (Is == m_lead ? loc : std::get<Is>(m_pools)->getLocation(id))) != invalid_id) && ...)
+                && (!m_filtered || changed(locs, std::index_sequence<Is...>()));
+        }
+
+        template<std::size_t... Is>
+        bool changed(const locations_t& locs, std::index_sequence<Is...>) const {
+            return ((tracks_changes_v<std::remove_const_t<comp_ts>> && std::get<Is>(m_pools)->changedSince(locs[Is], m_since)) || ...);
+        }
+
+        template<std::size_t I>
+        auto& getSlot(const emerald_id loc) const {
+            if constexpr(std::is_const<std::tuple_element_t<I, std::tuple<comp_ts...>>>::value) {
+                return std::as_const(*std::get<I>(m_pools)).getSlot(loc);
+            } else if(m_stamps[I]) {
+                return std::get<I>(m_pools)->writeSlot(loc);
+            } else {
+                return std::get<I>(m_pools)->getSlot(loc);
+            }
+        }
+
+        template<std::size_t... Is>
+        value_t get(const emerald_id loc, const locations_t& locs, std::index_sequence<Is...> indices) const {
+            return value_t(getLeadEntity(loc, indices), getSlot<Is>(locs[Is])...);
+        }
+
+        template<std::size_t... Is>
+        emerald_entity getLeadEntity(const emerald_id loc, std::index_sequence<Is...>) const {
+            emerald_entity id = invalid_entity;
+            ((m_lead == Is ? (id = std::get<Is>(m_pools)->getEntity(loc), 0) : 0), ...);
+            return id;
+        }
+
+        pools_t m_pools;
+        std::size_t m_lead;
+        emerald_id m_leadSize;
+        emerald_tick m_since;
+        bool m_filtered;
+        std::array<bool, sizeof...(comp_ts)> m_stamps;
+    };
+
+};
+
+#endif // _EMERALD_VIEW_H
@@ -0,0 +1,140 @@
+#include "../Emerald/archetype.hh"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace Emerald;
+
+class ComponentA {
+public:
+    ComponentA(int val) : m_val(val) {};
+    ComponentA(ComponentA&&) noexcept = default;
+    int getVal() const {
+        return m_val;
+    }
+private:
+    int m_val;
+};
+
+class ComponentB {
+public:
+    ComponentB(std::string name) : m_name(std::move(name)) {};
+    ComponentB(ComponentB&&) noexcept = default;
+    const std::string& getName() const {
+        return m_name;
+    }
+private:
+    std::string m_name;
+};
+
+// Throws from its constructor when asked to
+class ComponentC {
+public:
+    ComponentC(bool fail) : m_name("constructed") {
+        if(fail) {
+            throw std::runtime_error("ComponentC failed");
+        }
+    };
+    ComponentC(ComponentC&&) noexcept = default;
+    std::string m_name;
+};
+
+// Every chunk but the last is full and holds live entities that belong to the archetype
+bool checkArchetype(ArchetypeManager& archMan, Archetype* archetype, const std::size_t expected, const char* name) {
+    if(archetype == nullptr || archetype->getSize() != expected
+        || archetype->getChunkCount() != (expected + archetype->getChunkCapacity() - 1) / archetype->getChunkCapacity()) {
+        std::cout << "Archetype with " << name << " has the wrong size\n";
+        return false;
+    }
+    std::size_t rows = 0;
+    for(std::size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+        auto size = archetype->getChunkSize(chunk);
+        if(size != archetype->getChunkCapacity() && chunk + 1 != archetype->getChunkCount()) {
+            std::cout << "Archetype with " << name << " has a chunk that isn't full\n";
+            return false;
+        }
+        for(std::size_t i = 0; i < size; i++) {
+            if(!archMan.isEntityValid(archetype->getEntities(chunk)[i])) {
+                std::cout << "Archetype with " << name << " holds a removed entity\n";
+                return false;
+            }
+        }
+        rows += size;
+    }
+    return rows == expected;
+}
+
+int main() {
+    ArchetypeManager archMan(1024);
+    std::vector<emerald_entity> ids;
+    for(auto i = 0; i < 1000; i++) {
+        auto id = archMan.createEntity();
+        ids.push_back(id);
+        archMan.createComponent<ComponentA>(id, i);
+        if(i % 2 == 0) {
+            archMan.createComponent<ComponentB>(id, std::to_string(i));
+        }
+    }
+
+    for(auto i = 0; i < 1000; i += 3) {
+        archMan.removeEntity(ids[i]);
+    }
+    for(auto i = 0; i < 1000; i += 4) {
+        if(archMan.entityHasComponent<ComponentB>(ids[i])) {
+            archMan.removeComponent<ComponentB>(ids[i]);
+        }
+    }
+    if(archMan.entityHasComponent<ComponentA>(ids[0]) || !archMan.isEntityValid(archMan.createEntity())) {
+        std::cout << "Stale handle failure\n";
+        return 1;
+    }
+
+    // 334 removed, 166 of the rest lost B, and the new entity has nothing
+    if(!checkArchetype(archMan, archMan.getArchetype<ComponentA, ComponentB>(), 167, "A and B")
+        || !checkArchetype(archMan, archMan.getArchetype<ComponentA>(), 499, "A")
+        || !checkArchetype(archMan, archMan.getArchetype<>(), 1, "nothing") || archMan.getEntityCount() != 667) {
+        return 1;
+    }
+
+    std::vector<int> visits(ids.size(), 0);
+    auto mismatches = 0;
+    archMan.mapComponents<ComponentA, ComponentB>([&visits, &mismatches](auto& ca, auto& cb) {
+        mismatches += std::to_string(ca.getVal()) != cb.getName();
+        visits[ca.getVal()]++;
+    });
+    for(std::size_t i = 0; i < ids.size(); i++) {
+        if(visits[i] != (i % 3 != 0 && i % 4 == 2)) {
+            mismatches++;
+        }
+    }
+    if(mismatches != 0) {
+        std::cout << "Mapping failure\n";
+        return 1;
+    }
+
+    auto lost = 0;
+    archMan.mapEntities<ComponentA>([&archMan, &ids, &lost](emerald_entity id) {
+        lost += ids[archMan.getComponent<ComponentA>(id).getVal()] != id;
+    });
+    if(lost != 0) {
+        std::cout << lost << " entities lost their component\n";
+        return 1;
+    }
+
+    // A constructor that throws leaves the entity where it was, and nothing unconstructed behind
+    auto failing = ids[10];
+    archMan.createComponent<ComponentC>(ids[2], false);
+    try {
+        archMan.createComponent<ComponentC>(failing, true);
+        std::cout << "ComponentC didn't throw\n";
+        return 1;
+    } catch(const std::runtime_error&) {}
+    if(archMan.entityHasComponent<ComponentC>(failing) || archMan.getComponent<ComponentA>(failing).getVal() != 10
+        || archMan.getComponent<ComponentB>(failing).getName() != "10"
+        || !checkArchetype(archMan, archMan.getArchetype<ComponentA, ComponentB, ComponentC>(), 1, "A, B and C")) {
+        std::cout << "Throwing constructor changed the entity\n";
+        return 1;
+    }
+    archMan.removeEntity(ids[2]);
+}
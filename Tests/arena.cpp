@@ -0,0 +1,112 @@
+#include "../Emerald/entitymanager.hh"
+#include "../Emerald/Util/memory.hh"
+#include <iostream>
+#include <chrono>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Velocity {
+public:
+    Velocity(float val) : m_val(val) {};
+    float m_val;
+};
+
+using Manager = EntityManager<Position, Velocity>;
+
+constexpr int entity_count = 1000000;
+constexpr int frames = 100;
+
+// Counts what reaches the resource underneath, to check a world only asks for it once
+class CountingResource : public std::pmr::memory_resource {
+public:
+    CountingResource(std::pmr::memory_resource* upstream) : m_upstream(upstream) {};
+    std::pmr::memory_resource* m_upstream;
+    std::size_t m_allocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        m_allocations++;
+        return m_upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* data, std::size_t bytes, std::size_t alignment) override {
+        m_upstream->deallocate(data, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+template<typename func_t>
+long long timed(func_t func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void build(Manager& world) {
+    world.createEntities(entity_count, [&world](emerald_entity id, std::size_t i) {
+        world.createComponent<Position>(id, (float)i);
+        if(i % 2 == 0) {
+            world.createComponent<Velocity>(id, 1.0f);
+        }
+    });
+}
+
+// Loads and unloads the same level on the global heap and in an arena reserved up front, the second time
+// around so neither pays for first touching its memory
+int main() {
+    long long heapTime = 0;
+    for(auto load = 0; load < 2; load++) {
+        heapTime = timed([] {
+            Manager world;
+            build(world);
+        });
+    }
+
+    HugePageResource hugePages;
+    CountingResource counter(&hugePages);
+    ArenaResource level(std::size_t(128) << 20, &counter);
+    long long arenaTime = 0;
+    for(auto load = 0; load < 2; load++) {
+        level.reset();
+        arenaTime = timed([&level] {
+            Manager world(&level);
+            build(world);
+        });
+    }
+    auto used = level.getUsed();
+    auto releaseTime = timed([&level] {
+        level.release();
+    });
+    std::cout << "Level loaded on the heap in " << heapTime << "us, in the arena in " << arenaTime << "us using "
+              << used / 1024 << "KB, released in " << releaseTime << "us\n";
+    if(counter.m_allocations != 1) {
+        std::cout << "World went past the arena " << counter.m_allocations << " times\n";
+        return 1;
+    }
+
+    // Scratch memory for a frame is handed out and thrown away all at once
+    ArenaResource frame(std::size_t(1) << 20);
+    Manager world;
+    build(world);
+    for(auto i = 0; i < frames; i++) {
+        frame.reset();
+        std::pmr::vector<emerald_entity> moving(&frame);
+        world.view<const Velocity>().map([&moving](emerald_entity id, const Velocity&) {
+            moving.push_back(id);
+        });
+        if(moving.size() != entity_count / 2) {
+            std::cout << "Scratch list has " << moving.size() << " entities\n";
+            return 1;
+        }
+    }
+    std::cout << "Frame arena reserved " << frame.getReserved() / 1024 << "KB\n";
+}
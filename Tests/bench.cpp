@@ -0,0 +1,226 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstring>
+
+using namespace Emerald;
+
+// Benchmarks the manager over a sweep of entity counts and component sizes. Every benchmark is run once to
+// warm up and then repeatedly, the statistics are in nanoseconds per entity and are also written as CSV
+//
+//     bench [--max-entities N] [--repetitions N] [--output bench.csv]
+
+template<std::size_t bytes>
+class Blob {
+public:
+    Blob(uint32_t val) {
+        std::fill_n(m_data, bytes / sizeof(uint32_t), val);
+    }
+    uint32_t m_data[bytes / sizeof(uint32_t)];
+};
+
+class Velocity {
+public:
+    Velocity(uint32_t val) : m_val(val) {};
+    uint32_t m_val;
+};
+
+// Results are summed into this so the loops being timed can't be optimized away
+volatile uint64_t sink = 0;
+
+struct Options {
+    std::size_t maxEntities = 1000000;
+    std::size_t repetitions = 10;
+    std::string output = "bench.csv";
+};
+
+struct Result {
+    std::string name;
+    std::size_t entities;
+    std::size_t componentBytes;
+    std::size_t repetitions;
+    double median, min, mean, stddev;
+};
+
+// run does its own setup and returns the nanoseconds spent in the part being measured
+template<typename run_t>
+Result measure(const Options& options, const char* name, const std::size_t entities, const std::size_t componentBytes,
+               const std::size_t operations, run_t run) {
+    run();
+    std::vector<double> samples;
+    for(std::size_t i = 0; i < options.repetitions; i++) {
+        samples.push_back(run() / operations);
+    }
+    std::sort(samples.begin(), samples.end());
+    auto mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    auto variance = 0.0;
+    for(auto sample : samples) {
+        variance += (sample - mean) * (sample - mean);
+    }
+    Result result {name, entities, componentBytes, samples.size(), samples[samples.size() / 2], samples.front(), mean,
+                   std::sqrt(variance / samples.size())};
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(9) << entities << std::setw(5) << componentBytes << "B "
+              << std::fixed << std::setprecision(2) << std::setw(10) << result.median << " ns/entity (min " << result.min
+              << ", stddev " << result.stddev << ")\n";
+    return result;
+}
+
+template<typename func_t>
+double timed(func_t func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename blob_t>
+using Manager = EntityManager<blob_t, Velocity>;
+
+template<typename blob_t>
+class Integrate : public ISystem<Integrate<blob_t>, Reads<Velocity>, Writes<blob_t>> {
+public:
+    void update(Manager<blob_t>& entMan) {
+        entMan.template view<blob_t, const Velocity>().map([](emerald_entity, blob_t& blob, const Velocity& vel) {
+            blob.m_data[0] += vel.m_val;
+        });
+    }
+};
+
+template<typename blob_t>
+class Sum : public ISystem<Sum<blob_t>, Reads<blob_t>> {
+public:
+    void update(Manager<blob_t>& entMan) {
+        uint64_t total = 0;
+        entMan.template view<const blob_t>().map([&total](emerald_entity, const blob_t& blob) {
+            total += blob.m_data[0];
+        });
+        sink = sink + total;
+    }
+};
+
+// Every entity gets a blob, every other one a velocity too
+template<typename blob_t>
+std::vector<emerald_entity> populate(Manager<blob_t>& entMan, const std::size_t entities) {
+    entMan.template reserve<blob_t>(entities);
+    entMan.template reserve<Velocity>(entities / 2);
+    return entMan.createEntities(entities, [&entMan](emerald_entity id, std::size_t i) {
+        entMan.template createComponent<blob_t>(id, (uint32_t)i);
+        if(i % 2 == 0) {
+            entMan.template createComponent<Velocity>(id, 1);
+        }
+    });
+}
+
+template<std::size_t bytes>
+void runSuite(const Options& options, std::vector<Result>& results) {
+    using blob_t = Blob<bytes>;
+    for(std::size_t entities = 1000; entities <= options.maxEntities; entities *= 10) {
+        results.push_back(measure(options, "create_destroy", entities, bytes, entities, [entities] {
+            Manager<blob_t> entMan;
+            std::vector<emerald_entity> ids;
+            auto time = timed([&] {
+                ids = populate(entMan, entities);
+            });
+            return time + timed([&] {
+                for(auto id : ids) {
+                    entMan.removeEntity(id);
+                }
+            });
+        }));
+
+        Manager<blob_t> entMan;
+        auto ids = populate(entMan, entities);
+        results.push_back(measure(options, "iterate_one", entities, bytes, entities, [&entMan] {
+            return timed([&entMan] {
+                uint64_t total = 0;
+                entMan.template view<const blob_t>().map([&total](emerald_entity, const blob_t& blob) {
+                    total += blob.m_data[0];
+                });
+                sink = sink + total;
+            });
+        }));
+        results.push_back(measure(options, "iterate_two", entities, bytes, entities / 2, [&entMan] {
+            return timed([&entMan] {
+                entMan.template view<blob_t, const Velocity>().map([](emerald_entity, blob_t& blob, const Velocity& vel) {
+                    blob.m_data[0] += vel.m_val;
+                });
+            });
+        }));
+
+        std::vector<emerald_entity> shuffled = ids;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(entities));
+        results.push_back(measure(options, "random_access", entities, bytes, entities, [&entMan, &shuffled] {
+            return timed([&entMan, &shuffled] {
+                uint64_t total = 0;
+                for(auto id : shuffled) {
+                    total += entMan.template getComponent<blob_t>(id).m_data[0];
+                }
+                sink = sink + total;
+            });
+        }));
+
+        // A tenth of the world is destroyed and replaced in random order every run
+        std::mt19937 random(entities);
+        auto churned = std::max<std::size_t>(entities / 10, 1);
+        results.push_back(measure(options, "churn", entities, bytes, churned, [&entMan, &ids, &random, churned] {
+            return timed([&entMan, &ids, &random, churned] {
+                for(std::size_t i = 0; i < churned; i++) {
+                    auto& id = ids[random() % ids.size()];
+                    entMan.removeEntity(id);
+                    id = entMan.createEntity();
+                    entMan.template createComponent<blob_t>(id, (uint32_t)i);
+                    if(i % 2 == 0) {
+                        entMan.template createComponent<Velocity>(id, 1);
+                    }
+                }
+            });
+        }));
+
+        entMan.template registerSystem<Integrate<blob_t>>();
+        entMan.template registerSystem<Sum<blob_t>>();
+        results.push_back(measure(options, "update_systems", entities, bytes, entities, [&entMan] {
+            return timed([&entMan] {
+                entMan.updateSystems();
+            });
+        }));
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(std::strcmp(argv[i], "--max-entities") == 0) {
+            options.maxEntities = std::stoul(argv[i + 1]);
+        } else if(std::strcmp(argv[i], "--repetitions") == 0) {
+            options.repetitions = std::max<std::size_t>(std::stoul(argv[i + 1]), 1);
+        } else if(std::strcmp(argv[i], "--output") == 0) {
+            options.output = argv[i + 1];
+        } else {
+            std::cout << "Unknown option " << argv[i] << '\n';
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    runSuite<4>(options, results);
+    runSuite<16>(options, results);
+    runSuite<64>(options, results);
+    runSuite<256>(options, results);
+
+    std::ofstream csv(options.output);
+    csv << "benchmark,entities,component_bytes,repetitions,median_ns,min_ns,mean_ns,stddev_ns\n";
+    for(auto& result : results) {
+        csv << result.name << ',' << result.entities << ',' << result.componentBytes << ',' << result.repetitions << ','
+            << result.median << ',' << result.min << ',' << result.mean << ',' << result.stddev << '\n';
+    }
+    if(!csv) {
+        std::cout << "Couldn't write " << options.output << '\n';
+        return 1;
+    }
+    std::cout << "Wrote " << results.size() << " results to " << options.output << '\n';
+}
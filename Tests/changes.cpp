@@ -0,0 +1,121 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+using namespace Emerald;
+
+class Transform {
+public:
+    Transform(float val) : m_val(val) {};
+    float m_val;
+};
+
+template<>
+struct Emerald::PoolTraits<Transform> {
+    static constexpr PoolLayout layout = PoolLayout::Stable;
+    static constexpr bool track_changes = true;
+};
+
+class Velocity {
+public:
+    Velocity(float val) : m_val(val) {};
+    float m_val;
+};
+
+using Manager = EntityManager<Transform, Velocity>;
+
+constexpr int entity_count = 100000;
+
+// Only one in twenty entities moves every frame
+class Movement : public ISystem<Movement, Reads<Velocity>, Writes<Transform>> {
+public:
+    void update(Manager& entMan) {
+        entMan.view<const Velocity>().map([&entMan](emerald_entity id, const Velocity& vel) {
+            if(vel.m_val != 0.0f) {
+                entMan.getComponent<Transform>(id).m_val += vel.m_val;
+                entMan.markChanged<Transform>(id);
+            }
+        });
+    }
+};
+
+// Reads every transform without marking any of them changed
+class Bounds : public ISystem<Bounds, Reads<Transform>> {
+public:
+    void update(Manager& entMan) {
+        m_entities.map([this, &entMan](emerald_entity id) {
+            m_max = std::max(m_max, entMan.getComponent<Transform>(id).m_val);
+        });
+    }
+    float m_max = 0.0f;
+};
+
+// Maps transforms through mutable references but only declares that it reads them, so it doesn't mark them changed
+class Inspect : public ISystem<Inspect, Reads<Transform>> {
+public:
+    void update(Manager& entMan) {
+        entMan.mapComponents<Transform>([this](Transform& transform) {
+            m_total += transform.m_val;
+        });
+        entMan.parallelMapComponents<Transform>([](Transform& transform) {
+            (void)transform;
+        });
+    }
+    float m_total = 0.0f;
+};
+
+// Only looks at the transforms that changed since the last time it ran
+class RenderSync : public ISystem<RenderSync, Reads<Transform>> {
+public:
+    void update(Manager& entMan) {
+        m_synced = 0;
+        entMan.view<const Transform>().changedSince(getLastTick()).map([this](emerald_entity, const Transform&) {
+            m_synced++;
+        });
+    }
+    int m_synced;
+};
+
+int main() {
+    Manager entMan;
+    entMan.registerSystem<Movement>();
+    entMan.registerSystem<Bounds>();
+    entMan.registerSystem<Inspect>();
+    entMan.registerSystem<RenderSync>();
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Transform>(id, 0.0f);
+        entMan.createComponent<Velocity>(id, i % 20 == 0 ? 1.0f : 0.0f);
+    }
+
+    entMan.updateSystems();
+    if(entMan.getSystem<RenderSync>().m_synced != entity_count) {
+        std::cout << "New components should count as changed\n";
+        return 1;
+    }
+    for(auto frame = 0; frame < 3; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        entMan.updateSystems();
+        auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Frame " << frame << " synced " << entMan.getSystem<RenderSync>().m_synced << " transforms in " << time << "us\n";
+        if(entMan.getSystem<RenderSync>().m_synced != entity_count / 20) {
+            return 1;
+        }
+    }
+
+    // With nothing moving, a frame of systems that only read transforms leaves none of them changed
+    entMan.view<Velocity>().map([](emerald_entity, Velocity& vel) {
+        vel.m_val = 0.0f;
+    });
+    auto tick = entMan.getTick();
+    entMan.updateSystems();
+    std::size_t changed = 0;
+    entMan.view<const Transform>().changedSince(tick).map([&changed](emerald_entity, const Transform&) {
+        changed++;
+    });
+    if(changed != 0) {
+        std::cout << changed << " transforms were marked changed by systems that only read them\n";
+        return 1;
+    }
+}
@@ -0,0 +1,78 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+
+using namespace Emerald;
+
+class Health {
+public:
+    Health(int val) : m_val(val) {};
+    int m_val;
+};
+
+class Corpse {
+public:
+    Corpse(int val) : m_val(val) {};
+    int m_val;
+};
+
+using Manager = EntityManager<Health, Corpse>;
+
+constexpr int entity_count = 100000;
+
+// Kills every entity whose health ran out while mapping them, every corpse spawns a new entity in its place
+class Reaper : public ISystem<Reaper, Reads<Health>, Writes<Corpse>> {
+public:
+    void update(Manager& entMan) {
+        auto& commands = entMan.getCommandBuffer();
+        entMan.mapEntities<Health>([&entMan, &commands](const emerald_entity id) {
+            if(entMan.getComponent<Health>(id).m_val % 2 == 0) {
+                commands.removeEntity(id);
+                auto spawn = commands.createEntity();
+                commands.createComponent<Health>(spawn, 1);
+                commands.createComponent<Corpse>(spawn, 0);
+            }
+        });
+    }
+};
+
+int main() {
+    Manager entMan;
+    entMan.registerSystem<Reaper>();
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Health>(id, i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    entMan.updateSystems();
+    std::cout << "Update took " << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() << "us\n";
+
+    int corpses = 0;
+    entMan.mapComponents<Health, Corpse>([&corpses](auto&, auto&) {
+        corpses++;
+    });
+    if(entMan.getEntityCount() != entity_count || corpses != entity_count / 2 || !entMan.getCommandBuffer().isEmpty()) {
+        std::cout << "Commands weren't applied, " << entMan.getEntityCount() << " entities and " << corpses << " corpses\n";
+        return 1;
+    }
+
+    // Commands on the same component of the same entity happen in the order they were recorded
+    auto& commands = entMan.getCommandBuffer();
+    auto replaced = entMan.createEntity();
+    auto removed = entMan.createEntity();
+    auto kept = entMan.createEntity();
+    entMan.createComponent<Health>(replaced, 1);
+    entMan.createComponent<Health>(kept, 1);
+    commands.removeComponent<Health>(replaced);
+    commands.createComponent<Health>(replaced, 2);
+    commands.createComponent<Health>(removed, 2);
+    commands.removeComponent<Health>(removed);
+    commands.createComponent<Health>(kept, 2);
+    commands.flush(entMan);
+    if(entMan.getComponent<Health>(replaced).m_val != 2 || entMan.entityHasComponents<Health>(removed) || entMan.getComponent<Health>(kept).m_val != 1) {
+        std::cout << "Commands were applied out of order\n";
+        return 1;
+    }
+    std::cout << "Commands applied\n";
+}
@@ -0,0 +1,84 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Health {
+public:
+    Health(int val) : m_val(val) {};
+    int m_val;
+};
+
+template<>
+struct Emerald::PoolTraits<Health> {
+    static constexpr PoolLayout layout = PoolLayout::Packed;
+};
+
+using Manager = EntityManager<Position, Health>;
+
+constexpr int entity_count = 1000000;
+const auto frame_budget = std::chrono::microseconds(500);
+
+void printStats(const char* when, const PoolStats& stats) {
+    std::cout << when << ": " << stats.live << " live, " << stats.capacity << " capacity, " << stats.tombstones << " tombstones, "
+              << stats.bytes / 1024 << "KB\n";
+}
+
+// After nine in ten entities despawn the pools are compacted a little every frame
+int main() {
+    Manager entMan;
+    auto ids = entMan.createEntitiesWith(entity_count, Position(0.0f), Health(0));
+    for(auto i = 0; i < entity_count; i++) {
+        entMan.getComponent<Position>(ids[i]).m_val = i;
+        entMan.getComponent<Health>(ids[i]).m_val = i;
+    }
+    printStats("Spawned", entMan.getPoolStats());
+    for(auto i = 0; i < entity_count; i++) {
+        if(i % 10 != 3) {
+            entMan.removeEntity(ids[i]);
+        }
+    }
+    auto before = entMan.getPoolStats<Position>();
+    printStats("Despawned", entMan.getPoolStats());
+
+    auto frames = 0;
+    long long slowest = 0;
+    for(auto done = false; !done; frames++) {
+        auto start = std::chrono::steady_clock::now();
+        done = entMan.compact(frame_budget);
+        slowest = std::max<long long>(slowest, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+    entMan.shrinkToFit();
+    auto after = entMan.getPoolStats<Position>();
+    printStats("Compacted", entMan.getPoolStats());
+    std::cout << "Compacted over " << frames << " frames, slowest " << slowest << "us\n";
+
+    std::size_t mismatches = 0;
+    for(auto i = 3; i < entity_count; i += 10) {
+        if(entMan.getComponent<Position>(ids[i]).m_val != i || entMan.getComponent<Health>(ids[i]).m_val != i) {
+            mismatches++;
+        }
+    }
+    std::size_t viewed = 0;
+    entMan.view<const Position, const Health>().map([&viewed](emerald_entity, const Position& pos, const Health& health) {
+        viewed += pos.m_val == health.m_val;
+    });
+    if(mismatches > 0 || viewed != entity_count / 10 || after.tombstones != 0 || after.live != before.live || after.bytes * 3 > before.bytes) {
+        std::cout << "Compacted pools don't match, " << mismatches << " mismatches\n";
+        return 1;
+    }
+
+    auto id = entMan.createEntity();
+    entMan.createComponent<Position>(id, -1.0f);
+    if(entMan.getComponent<Position>(id).m_val != -1.0f || entMan.getPoolStats<Position>().live != after.live + 1) {
+        std::cout << "Pool doesn't grow again after compacting\n";
+        return 1;
+    }
+}
@@ -0,0 +1,253 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <typeinfo>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float x, float y) : m_x(x), m_y(y) {};
+    float m_x, m_y;
+};
+
+class Health {
+public:
+    Health(int val) : m_val(val) {};
+    int m_val;
+};
+
+class Name {
+public:
+    Name(std::string name) : m_name(std::move(name)) {};
+    Name(Name&&) noexcept = default;
+    std::string m_name;
+};
+
+class Burning {};
+
+template<>
+struct Emerald::PoolTraits<Position> {
+    static constexpr PoolLayout layout = PoolLayout::Stable;
+    static constexpr bool track_changes = true;
+};
+
+template<>
+struct Emerald::PoolTraits<Health> {
+    static constexpr PoolLayout layout = PoolLayout::Packed;
+    static constexpr bool track_changes = true;
+};
+
+template<>
+struct Emerald::PoolTraits<Name> {
+    static constexpr PoolLayout layout = PoolLayout::Stable;
+    static constexpr bool track_changes = true;
+};
+
+template<>
+struct Emerald::Serializer<Name> {
+    static void write(SnapshotWriter& writer, const Name& name) {
+        writer.write(name.m_name);
+    }
+
+    static Name read(SnapshotReader& reader) {
+        return Name(reader.readString());
+    }
+};
+
+using Manager = EntityManager<Position, Health, Name, Burning>;
+
+constexpr int entity_count = 100000;
+constexpr int frames = 20;
+const char* snapshot_path = "delta.emerald";
+
+bool matches(Manager& server, Manager& client) {
+    std::size_t mismatches = 0;
+    server.mapEntities([&server, &client, &mismatches](const emerald_entity id) {
+        if(!client.isEntityValid(id) || client.getComponent<Position>(id).m_x != server.getComponent<Position>(id).m_x
+            || client.entityHasComponent<Health>(id) != server.entityHasComponent<Health>(id)
+            || (server.entityHasComponents<Health>(id) && client.getComponent<Health>(id).m_val != server.getComponent<Health>(id).m_val)
+            || client.entityHasComponents<Name>(id) != server.entityHasComponents<Name>(id)
+            || (server.entityHasComponents<Name>(id) && client.getComponent<Name>(id).m_name != server.getComponent<Name>(id).m_name)
+            || client.entityHasComponents<Burning>(id) != server.entityHasComponents<Burning>(id)) {
+            mismatches++;
+        }
+    });
+    return mismatches == 0 && client.getEntityCount() == server.getEntityCount()
+        && client.view<const Health>().getSizeHint() == server.view<const Health>().getSizeHint()
+        && client.view<const Burning>().getSizeHint() == server.view<const Burning>().getSizeHint();
+}
+
+// Where the first changed entity's index is in a delta, past the header, the two ticks and the counts
+std::size_t changesOffset() {
+    auto offset = sizeof(delta_magic) + 3 * sizeof(uint32_t);
+    for(auto name : {typeid(Position).name(), typeid(Health).name(), typeid(Name).name(), typeid(Burning).name()}) {
+        offset += sizeof(uint64_t) + std::strlen(name);
+    }
+    return offset + 2 * sizeof(emerald_tick) + 2 * sizeof(uint64_t);
+}
+
+// Applies a small world's first delta and then second to a new spectator. A second delta that's rejected has to
+// leave the spectator as the first left it or empty, one that's applied has every component owned by a live entity
+bool appliesCleanly(const std::vector<char>& first, const std::vector<char>& second, bool& rejected) {
+    Manager client;
+    client.applyDelta(first);
+    auto entities = client.getEntityCount();
+    auto components = client.getPoolStats().live;
+    rejected = false;
+    try {
+        client.applyDelta(second);
+    } catch(const BadSnapshot&) {
+        rejected = true;
+        return (client.getEntityCount() == entities && client.getPoolStats().live == components)
+            || (client.getEntityCount() == 0 && client.getPoolStats().live == 0);
+    }
+    auto owned = true;
+    client.view<const Position>().map([&client, &owned](emerald_entity id, const Position&) {
+        owned = owned && client.isEntityValid(id);
+    });
+    client.view<const Name>().map([&client, &owned](emerald_entity id, const Name&) {
+        owned = owned && client.isEntityValid(id);
+    });
+    client.view<const Burning>().map([&client, &owned](emerald_entity id, const Burning&) {
+        owned = owned && client.isEntityValid(id);
+    });
+    return owned;
+}
+
+// Every cut short and every single corrupted byte of a small delta is either applied or rejected cleanly, and
+// an entity index out of range is rejected before anything changes
+bool rejectsCorruption() {
+    Manager small;
+    std::vector<emerald_entity> ids;
+    for(auto i = 0; i < 6; i++) {
+        ids.push_back(small.createEntity());
+        small.createComponent<Position>(ids.back(), (float)i, 0.0f);
+    }
+    std::vector<char> first;
+    std::vector<char> second;
+    auto tick = small.makeDelta(0, first);
+    small.removeEntity(ids[1]);
+    small.createComponent<Name>(small.createEntity(), "respawned");
+    small.createComponent<Burning>(ids[2]);
+    small.makeDelta(tick, second);
+
+    bool rejected = false;
+    if(!appliesCleanly(first, second, rejected) || rejected) {
+        std::cout << "Small delta didn't apply\n";
+        return false;
+    }
+    auto outOfRange = second;
+    auto index = ~emerald_id(0) - 1;
+    std::memcpy(outOfRange.data() + changesOffset(), &index, sizeof(index));
+    Manager client;
+    client.applyDelta(first);
+    try {
+        client.applyDelta(outOfRange);
+        std::cout << "Delta entity out of range wasn't rejected\n";
+        return false;
+    } catch(const BadSnapshot&) {}
+    if(client.getEntityCount() != 6 || client.getPoolStats().live != 6) {
+        std::cout << "Rejected delta changed the spectator\n";
+        return false;
+    }
+    for(std::size_t size = 0; size < second.size(); size++) {
+        if(!appliesCleanly(first, std::vector<char>(second.begin(), second.begin() + size), rejected) || !rejected) {
+            std::cout << "Delta cut to " << size << " bytes wasn't rejected\n";
+            return false;
+        }
+    }
+    for(std::size_t i = 0; i < second.size(); i++) {
+        auto corrupt = second;
+        corrupt[i] = (char)0xFF;
+        if(!appliesCleanly(first, corrupt, rejected)) {
+            std::cout << "Corrupting delta byte " << i << " broke the spectator\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Replicates a world to a spectator with one delta a frame, a few percent of the world changes each frame
+int main() {
+    if(!rejectsCorruption()) {
+        return 1;
+    }
+    Manager server;
+    Manager client;
+    std::vector<emerald_entity> ids = server.createEntities(entity_count, [&server](emerald_entity id, std::size_t i) {
+        server.createComponent<Position>(id, (float)i, 0.0f);
+        server.createComponent<Health>(id, 100);
+        if(i % 50 == 0) {
+            server.createComponent<Name>(id, "entity " + std::to_string(i));
+        }
+        if(i % 7 == 0) {
+            server.createComponent<Burning>(id);
+        }
+    });
+
+    std::vector<char> delta;
+    auto tick = server.makeDelta(0, delta);
+    client.applyDelta(delta);
+    std::cout << "Initial delta " << delta.size() / 1024 << "KB\n";
+
+    std::size_t deltaBytes = 0;
+    long long applyTime = 0;
+    for(auto frame = 1; frame <= frames; frame++) {
+        for(auto i = frame; i < entity_count; i += 40) {
+            server.getComponent<Position>(ids[i]).m_x += 1.0f;
+            server.markChanged<Position>(ids[i]);
+        }
+        for(auto i = frame; i < entity_count; i += 500) {
+            server.removeEntity(ids[i]);
+            ids[i] = server.createEntity();
+            server.createComponent<Position>(ids[i], (float)-i, 0.0f);
+            server.createComponent<Name>(ids[i], "respawned " + std::to_string(frame));
+        }
+        for(auto i = frame + 7; i < entity_count; i += 300) {
+            if(server.entityHasComponents<Health>(ids[i])) {
+                server.removeComponent<Health>(ids[i]);
+            } else {
+                server.createComponent<Health>(ids[i], frame);
+            }
+        }
+        for(auto i = frame + 3; i < entity_count; i += 100) {
+            if(server.entityHasComponents<Burning>(ids[i])) {
+                server.removeComponent<Burning>(ids[i]);
+            } else {
+                server.createComponent<Burning>(ids[i]);
+            }
+        }
+        tick = server.makeDelta(tick, delta);
+        server.forgetChanges(tick);
+        deltaBytes += delta.size();
+        auto start = std::chrono::steady_clock::now();
+        client.applyDelta(delta);
+        applyTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // A spectator joining late gets every tag from a delta since 0, even though the server forgot older changes
+    Manager late;
+    server.makeDelta(0, delta);
+    late.applyDelta(delta);
+
+    server.saveSnapshot(snapshot_path);
+    std::ifstream file(snapshot_path, std::ios::binary | std::ios::ate);
+    std::size_t snapshotBytes = file.tellg();
+    file.close();
+    std::remove(snapshot_path);
+
+    if(!matches(server, client)) {
+        std::cout << "Spectator world doesn't match\n";
+        return 1;
+    }
+    if(!matches(server, late)) {
+        std::cout << "Late spectator world doesn't match\n";
+        return 1;
+    }
+    std::cout << "Average delta " << deltaBytes / frames / 1024 << "KB against a " << snapshotBytes / 1024 << "KB snapshot, applied in "
+        << applyTime / frames << "us\n";
+}
@@ -3,23 +3,10 @@
 #include <memory>
 #include <vector>
 #include <unordered_map>
-#include <chrono>
 
 using namespace Emerald;
 using namespace std;
 
-auto fib(int n) {
-    auto v1 = -1;
-    auto v2 = 1;
-    auto total = 0;
-    for(int i = 0; i <= n; i++) {
-        total = v2 + v1;
-        v1 = v2;
-        v2 = total;
-    }
-    return v2;
-}
-
 class ComponentA {
 public:
     ComponentA(int val) : m_val(val) {};
@@ -65,104 +52,72 @@ private:
     int m_val;
 };
 
-class sys : public ISystem<sys> {
+using Manager = EntityManager<ComponentA, ComponentB, ComponentC>;
+
+class sys : public ISystem<sys, Reads<ComponentA, ComponentC>> {
 public:
-    void update(EntityManager& entMan) {
-        auto start = chrono::system_clock::now();
+    void update(Manager& entMan) {
         auto aview = entMan.getComponentView<ComponentA>();
         auto cview = entMan.getComponentView<ComponentC>();
-        entMan.mapEntities<ComponentA, ComponentC>([&aview, &cview, &entMan](emerald_id ent) {
+        m_entities.map([this, &aview, &cview, &entMan](emerald_entity ent) {
             auto& compa = aview[entMan.entityHasComponent<ComponentA>(ent)];
             auto& compc = cview[entMan.entityHasComponent<ComponentC>(ent)];
             if(compa.getVal() != compc.getVal()) {
-                std::cout << "error\n";
+                m_errors++;
             }
         });
-        std::cout << "system1 in " << chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now() - start).count() << '\n';
-        start = chrono::system_clock::now();
-        entMan.mapComponents<ComponentA, ComponentC>([](auto& ca, auto& cc) {
+        entMan.mapComponents<ComponentA, ComponentC>([this](auto& ca, auto& cc) {
             if(ca.getVal() != cc.getVal()) {
-                std::cout << "error\n";
+                m_errors++;
             }
         });
-        std::cout << "system2 in " << chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now() - start).count() << '\n';
     }
+    int m_errors = 0;
 };
 
-EntityManager entMan;
+Manager entMan;
 
 void createEntities() {
-    auto& s = entMan.getSystem<sys>();
-    for(auto a = 0; a < 1000; a++) {
-        auto id = entMan.createEntity();
-        entMan.createComponent<ComponentA>(id, id);
-        entMan.createComponent<ComponentB>(id, id);
-        entMan.createComponent<ComponentC>(id, id);
-        s.subscribe(id);
-    }
+    entMan.reserve<ComponentA>(1000);
+    entMan.reserve<ComponentB>(1000);
+    entMan.reserve<ComponentC>(1000);
+    entMan.createEntities(1000, [](emerald_entity id, int a) {
+        entMan.createComponent<ComponentA>(id, a);
+        entMan.createComponent<ComponentB>(id, a);
+        entMan.createComponent<ComponentC>(id, a);
+    });
 }
 
-// Using a view seems to be at the very least ~15% faster
+// Timings live in bench.cpp, this only checks the different ways of reaching components agree
 int main() {
     entMan.registerSystem<sys>();
     createEntities();
 
-    entMan.updateSystems(1.0f);
+    entMan.updateSystems();
+    if(entMan.getSystem<sys>().m_errors > 0 || entMan.getSystem<sys>().getEntities().getSize() != 1000) {
+        std::cout << "System saw mismatched components\n";
+        return 1;
+    }
 
-    if(entMan.entityHasComponents<ComponentA, ComponentB, ComponentC>(0)) {
-        std::cout << "Entity has components!\n";
-    } else {
+    if(!entMan.entityHasComponents<ComponentA, ComponentB, ComponentC>(0)) {
         std::cout << "Entity does not have components\n";
+        return 1;
     }
 
     int total = 0;
-    auto mstart = std::chrono::system_clock::now();
-    entMan.mapComponents<ComponentA, ComponentC>([](auto& ca, auto& cc) {
-        if(ca.getVal() != cc.getVal()) {
-            std::cout << "Mapping failure\n";
-        }
-    });
-    std::cout << "Map timing " << std::chrono::duration_cast<chrono::microseconds>(std::chrono::system_clock::now() - mstart).count() << '\n';
-
-    total = 0;
-    auto cstart = std::chrono::system_clock::now();
     for(auto& comp : entMan.getComponentView<ComponentA>()) {
-        fib(comp.getVal());
+        total += comp.getVal();
     }
-    for(auto& comp : entMan.getComponentView<ComponentC>()) {
-        fib(comp.getVal());
+    auto viewc = entMan.getComponentView<ComponentC>();
+    for(std::size_t i = 0; i < viewc.getSize(); i++) {
+        total -= viewc[i].getVal();
     }
-    std::cout << "Iter timing " << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - cstart).count() << '\n';
-
-    auto start = std::chrono::system_clock::now();
-    auto viewa = entMan.getComponentView<ComponentA>();
-    for(int i = 0; i < viewa.getSize(); i++) {
-        fib(viewa[i].getVal());
-    }
-    auto viewb = entMan.getComponentView<ComponentA>();
-    for(int i = 0; i < viewb.getSize(); i++) {
-        fib(viewb[i].getVal());
-    }
-    auto viewc = entMan.getComponentView<ComponentA>();
-    for(int i = 0; i < viewc.getSize(); i++) {
-        fib(viewc[i].getVal());
-    }
-    auto end = std::chrono::system_clock::now();
-    auto time1 = end - start;
-
-    std::cout << "begging map\n";
-
-    start = std::chrono::system_clock::now();
-    entMan.mapEntities([](emerald_id id) {
-        fib(entMan.getComponent<ComponentA>(id).getVal());
-        fib(entMan.getComponent<ComponentB>(id).getVal());
-        fib(entMan.getComponent<ComponentC>(id).getVal());
+    entMan.mapEntities([&total](emerald_entity id) {
+        total += entMan.getComponent<ComponentA>(id).getVal() - entMan.getComponent<ComponentB>(id).getVal();
     });
-    end = std::chrono::system_clock::now();
-    auto time2 = end - start;
-
-    std::cout << "Check 1 passed in " << std::chrono::duration_cast<std::chrono::microseconds>(time1).count() << "us\n";
-    std::cout << "Check 2 passed in " << std::chrono::duration_cast<std::chrono::microseconds>(time2).count() << "us\n";
-    std::cout << "Difference " << (double)(std::chrono::duration_cast<std::chrono::microseconds>(time2).count())
-            / std::chrono::duration_cast<std::chrono::microseconds>(time1).count() << '\n';
+    if(total != 0) {
+        std::cout << "Component views disagree\n";
+        return 1;
+    }
+    std::cout << "Checks passed\n";
 }
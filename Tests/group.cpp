@@ -0,0 +1,139 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <random>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+    float m_padding[7];
+};
+
+class Velocity {
+public:
+    Velocity(float val) : m_val(val) {};
+    float m_val;
+    float m_padding[7];
+};
+
+class Depth {
+public:
+    Depth(int val) : m_val(val) {};
+    int m_val;
+};
+
+template<>
+struct Emerald::PoolTraits<Position> {
+    static constexpr PoolLayout layout = PoolLayout::Packed;
+};
+
+template<>
+struct Emerald::PoolTraits<Velocity> {
+    static constexpr PoolLayout layout = PoolLayout::Packed;
+};
+
+using Manager = EntityManager<Position, Velocity, Depth>;
+
+constexpr int entity_count = 500000;
+constexpr int rounds = 20;
+
+template<typename func_t>
+double benchmark(func_t func) {
+    auto start = std::chrono::steady_clock::now();
+    for(auto round = 0; round < rounds; round++) {
+        func();
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+// Churns the world until both pools are shuffled, then compares a view join with the group that keeps them in step
+int main() {
+    std::mt19937 random(7);
+    Manager plain;
+    Manager grouped;
+    grouped.group<Position, Velocity>();
+    std::vector<emerald_entity> plainIds, groupedIds;
+    for(auto i = 0; i < entity_count; i++) {
+        for(auto manager : {&plain, &grouped}) {
+            auto id = manager->createEntity();
+            manager->createComponent<Position>(id, 0.0f);
+            if(i % 3 != 0) {
+                manager->createComponent<Velocity>(id, 1.0f);
+            }
+            (manager == &plain ? plainIds : groupedIds).push_back(id);
+        }
+    }
+    for(auto i = 0; i < entity_count; i++) {
+        auto victim = random() % entity_count;
+        auto velocity = random() % 3 != 0;
+        for(auto manager : {&plain, &grouped}) {
+            auto& id = (manager == &plain ? plainIds : groupedIds)[victim];
+            manager->removeEntity(id);
+            id = manager->createEntity();
+            if(velocity) {
+                manager->createComponent<Velocity>(id, 1.0f);
+            }
+            manager->createComponent<Position>(id, 0.0f);
+        }
+    }
+
+    auto& group = grouped.group<Position, Velocity>();
+    std::size_t joined = 0;
+    plain.view<const Position, const Velocity>().map([&joined](emerald_entity, const Position&, const Velocity&) {
+        joined++;
+    });
+    for(emerald_id i = 0; i < group.getSize(); i++) {
+        if(grouped.entityHasComponent<Position>(group.getEntity(i)) != i || grouped.entityHasComponent<Velocity>(group.getEntity(i)) != i) {
+            std::cout << "Group isn't in step at " << i << '\n';
+            return 1;
+        }
+    }
+    if(group.getSize() != joined) {
+        std::cout << "Group has " << group.getSize() << " entities, the view " << joined << '\n';
+        return 1;
+    }
+
+    auto viewTime = benchmark([&plain] {
+        plain.view<Position, const Velocity>().map([](emerald_entity, Position& pos, const Velocity& vel) {
+            pos.m_val += vel.m_val;
+        });
+    });
+    auto groupTime = benchmark([&group] {
+        group.map([](emerald_entity, Position& pos, Velocity& vel) {
+            pos.m_val += vel.m_val;
+        });
+    });
+    std::cout << "View join: " << viewTime << "us, group: " << groupTime << "us\n";
+
+    group.sort([](emerald_entity a, emerald_entity b) {
+        return entityIndex(a) < entityIndex(b);
+    });
+    for(emerald_id i = 1; i < group.getSize(); i++) {
+        if(entityIndex(group.getEntity(i - 1)) > entityIndex(group.getEntity(i)) || grouped.entityHasComponent<Velocity>(group.getEntity(i)) != i) {
+            std::cout << "Group isn't sorted\n";
+            return 1;
+        }
+    }
+
+    // Sorting a stable pool compacts it first
+    for(auto i = 0; i < entity_count; i++) {
+        grouped.createComponent<Depth>(groupedIds[i], (int)(random() % 1000));
+        if(i % 4 == 0) {
+            grouped.removeComponent<Depth>(groupedIds[i / 2]);
+        }
+    }
+    grouped.sort<Depth>([](const Depth& a, const Depth& b) {
+        return a.m_val < b.m_val;
+    });
+    auto previous = -1;
+    for(auto& depth : grouped.getComponentView<Depth>()) {
+        if(depth.m_val < previous) {
+            std::cout << "Depth isn't sorted\n";
+            return 1;
+        }
+        previous = depth.m_val;
+    }
+}
@@ -0,0 +1,48 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+using namespace Emerald;
+
+class ComponentA {
+public:
+    ComponentA(int val) : m_val(val) {};
+    ComponentA(ComponentA&&) noexcept = default;
+    int getVal() const {
+        return m_val;
+    }
+private:
+    int m_val;
+    char m_padding[60];
+};
+
+constexpr int entity_count = 1000000;
+
+// Creates a lot of components and checks that none of them moved while the pool grew, along with the slowest single insert
+int main() {
+    using Manager = EntityManager<ComponentA>;
+    Manager entMan;
+    std::vector<emerald_entity> ids;
+    std::vector<const ComponentA*> addresses;
+    long worst = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        auto insertStart = std::chrono::steady_clock::now();
+        entMan.createComponent<ComponentA>(id, i);
+        worst = std::max<long>(worst, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - insertStart).count());
+        ids.push_back(id);
+        addresses.push_back(&entMan.getComponent<ComponentA>(id));
+    }
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    for(auto i = 0; i < entity_count; i++) {
+        auto& comp = entMan.getComponent<ComponentA>(ids[i]);
+        if(&comp != addresses[i] || comp.getVal() != i) {
+            std::cout << "component " << i << " moved\n";
+            return 1;
+        }
+    }
+    std::cout << entity_count << " components in " << time << "us, slowest insert " << worst << "ns\n";
+}
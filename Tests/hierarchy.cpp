@@ -0,0 +1,168 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+using namespace Emerald;
+
+class Transform {
+public:
+    Transform(float x, float y) : m_x(x), m_y(y), m_worldX(x), m_worldY(y) {};
+    float m_x, m_y;
+    float m_worldX, m_worldY;
+};
+
+class Health {
+public:
+    Health(int val) : m_val(val) {};
+    int m_val;
+};
+
+template<>
+struct Emerald::PoolTraits<Transform> {
+    static constexpr PoolLayout layout = PoolLayout::Packed;
+};
+
+using Manager = EntityManager<Transform, Health>;
+
+constexpr int node_count = 100000;
+constexpr int rounds = 20;
+
+// Roots take their local transform as is, everything else adds its parent's
+void propagate(Manager& entMan) {
+    entMan.view<Transform>().map([](emerald_entity, Transform& transform) {
+        transform.m_worldX = transform.m_x;
+        transform.m_worldY = transform.m_y;
+    });
+    entMan.propagate<Transform>([](Transform& child, const Transform& parent) {
+        child.m_worldX = parent.m_worldX + child.m_x;
+        child.m_worldY = parent.m_worldY + child.m_y;
+    });
+}
+
+// What propagating should give, found by walking up to the root from every entity
+std::size_t countMismatches(Manager& entMan) {
+    std::size_t mismatches = 0;
+    entMan.view<const Transform>().map([&entMan, &mismatches](emerald_entity id, const Transform& transform) {
+        float x = 0, y = 0;
+        for(auto node = id; node != invalid_entity && entMan.entityHasComponents<Transform>(node); node = entMan.getHierarchy().getParent(node)) {
+            x += entMan.getComponent<Transform>(node).m_x;
+            y += entMan.getComponent<Transform>(node).m_y;
+        }
+        mismatches += std::abs(x - transform.m_worldX) > 0.01f || std::abs(y - transform.m_worldY) > 0.01f;
+    });
+    return mismatches;
+}
+
+// Every node is visited once and after its parent
+bool parentsFirst(Hierarchy& hierarchy, const std::size_t entities) {
+    auto ordered = true;
+    std::size_t visited = 0;
+    std::vector<bool> seen(entities, false);
+    hierarchy.map([&seen, &ordered, &visited](emerald_entity id, emerald_entity parent) {
+        ordered = ordered && !seen[entityIndex(id)] && (parent == invalid_entity || seen[entityIndex(parent)]);
+        seen[entityIndex(id)] = true;
+        visited++;
+    });
+    return ordered && visited == hierarchy.getSize();
+}
+
+int main() {
+    std::mt19937 random(11);
+    Manager entMan;
+    std::vector<emerald_entity> ids;
+    for(auto i = 0; i < node_count; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Health>(id, i);
+        entMan.createComponent<Transform>(id, (float)(random() % 10), (float)(random() % 10));
+        entMan.setParent(id, i % 50 != 0 ? ids[random() % i] : invalid_entity);
+        ids.push_back(id);
+    }
+    auto& hierarchy = entMan.getHierarchy();
+    propagate(entMan);
+    if(hierarchy.getSize() != node_count || countMismatches(entMan) != 0) {
+        std::cout << "Propagation doesn't match the hierarchy\n";
+        return 1;
+    }
+    if(!parentsFirst(hierarchy, node_count)) {
+        std::cout << "A child came before its parent\n";
+        return 1;
+    }
+
+    // Reparenting, cycles and removals, with removed entities' indices reused by new nodes
+    for(auto i = 0; i < node_count / 10; i++) {
+        auto child = ids[random() % node_count];
+        auto parent = ids[random() % node_count];
+        if(!entMan.isEntityValid(child) || !entMan.isEntityValid(parent)) {
+            continue;
+        }
+        try {
+            entMan.setParent(child, parent);
+        } catch(const BadID&) {}
+        if(i % 4 == 0) {
+            auto& victim = ids[random() % node_count];
+            entMan.removeEntity(victim);
+            victim = entMan.createEntity();
+            entMan.createComponent<Transform>(victim, 1.0f, 1.0f);
+            if(entMan.isEntityValid(parent)) {
+                entMan.setParent(victim, parent);
+            }
+        }
+    }
+    propagate(entMan);
+    if(countMismatches(entMan) != 0 || !parentsFirst(hierarchy, node_count)) {
+        std::cout << "Propagation doesn't match after changing the hierarchy\n";
+        return 1;
+    }
+
+    // Moving a leaf under a parent behind it only moves the leaf, everything else keeps its order
+    std::vector<emerald_entity> before;
+    hierarchy.map([&before](emerald_entity id, emerald_entity) {
+        before.push_back(id);
+    });
+    auto leaf = before.front();
+    for(auto id : before) {
+        auto childless = true;
+        hierarchy.mapChildren(id, [&childless](emerald_entity) {
+            childless = false;
+        });
+        if(childless) {
+            leaf = id;
+            break;
+        }
+    }
+    entMan.setParent(leaf, before.back());
+    std::vector<emerald_entity> after;
+    hierarchy.map([&after](emerald_entity id, emerald_entity) {
+        after.push_back(id);
+    });
+    before.erase(std::find(before.begin(), before.end(), leaf));
+    before.push_back(leaf);
+    if(after != before) {
+        std::cout << "Reparenting a leaf moved other nodes\n";
+        return 1;
+    }
+    auto root = entMan.createEntity();
+    auto child = entMan.createEntity();
+    entMan.setParent(child, root);
+    try {
+        entMan.setParent(root, child);
+        std::cout << "Made a cycle without an error\n";
+        return 1;
+    } catch(const BadID&) {}
+
+    auto start = std::chrono::steady_clock::now();
+    for(auto round = 0; round < rounds; round++) {
+        propagate(entMan);
+    }
+    auto propagateTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+    start = std::chrono::steady_clock::now();
+    auto mismatches = countMismatches(entMan);
+    auto chaseTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << hierarchy.getSize() << " nodes, propagate " << propagateTime << "us, chasing parents " << chaseTime << "us\n";
+    if(mismatches != 0) {
+        return 1;
+    }
+}
@@ -0,0 +1,55 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+using namespace Emerald;
+
+template<std::size_t N>
+class Component {
+public:
+    Component(int val) : m_val(val) {};
+    Component(Component&&) noexcept = default;
+    int getVal() const {
+        return m_val;
+    }
+private:
+    int m_val;
+};
+
+constexpr int entity_count = 10000;
+constexpr int lookup_rounds = 20;
+
+// Gives every entity count components and times looking up the one that was added last
+template<std::size_t... Is>
+void benchmark(std::index_sequence<Is...>) {
+    constexpr auto count = sizeof...(Is);
+    Emerald::EntityManager<::Component<Is>...> entMan;
+    std::vector<emerald_entity> ids;
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        ids.push_back(id);
+        (entMan.template createComponent<::Component<Is>>(id, i), ...);
+    }
+
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(auto round = 0; round < lookup_rounds; round++) {
+        for(auto id : ids) {
+            total += entMan.template getComponent<::Component<count - 1>>(id).getVal();
+        }
+    }
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << count << " components per entity: "
+              << (double)time / (entity_count * lookup_rounds) << "ns per lookup (" << total << ")\n";
+}
+
+int main() {
+    benchmark(std::make_index_sequence<1>());
+    benchmark(std::make_index_sequence<2>());
+    benchmark(std::make_index_sequence<4>());
+    benchmark(std::make_index_sequence<8>());
+    benchmark(std::make_index_sequence<16>());
+    benchmark(std::make_index_sequence<32>());
+}
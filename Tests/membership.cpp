@@ -0,0 +1,167 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <set>
+#include <cstdio>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Velocity {
+public:
+    Velocity(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Health {
+public:
+    Health(int val) : m_val(val) {};
+    int m_val;
+};
+
+using Manager = EntityManager<Position, Velocity, Health>;
+
+constexpr int entity_count = 200000;
+const char* snapshot_path = "membership.snapshot";
+
+class Movement : public ISystem<Movement, Reads<Velocity>, Writes<Position>> {
+public:
+    void update(Manager& entMan) {
+        m_entities.map([&entMan](emerald_entity id) {
+            entMan.getComponent<Position>(id).m_val += entMan.getComponent<Velocity>(id).m_val;
+        });
+    }
+};
+
+// Kills whatever runs out of health through the command buffer
+class Damage : public ISystem<Damage, Writes<Health>> {
+public:
+    void update(Manager& entMan) {
+        auto& commands = entMan.getCommandBuffer();
+        m_entities.map([&entMan, &commands](emerald_entity id) {
+            if(--entMan.getComponent<Health>(id).m_val == 0) {
+                commands.removeEntity(id);
+            }
+        });
+    }
+};
+
+class Idle : public ISystem<Idle> {
+public:
+    void update(Manager&) {}
+};
+
+// Members have to be exactly the entities a view of the same components finds, in index order
+template<typename system_t, typename... comp_ts>
+bool matchesView(Manager& entMan) {
+    std::vector<emerald_entity> viewed, members;
+    entMan.view<comp_ts...>().map([&viewed](emerald_entity id, comp_ts&...) {
+        viewed.push_back(id);
+    });
+    std::sort(viewed.begin(), viewed.end(), [](emerald_entity a, emerald_entity b) {
+        return entityIndex(a) < entityIndex(b);
+    });
+    entMan.getSystem<system_t>().getEntities().map([&members](emerald_entity id) {
+        members.push_back(id);
+    });
+    return viewed == members && members.size() == entMan.getSystem<system_t>().getEntities().getSize();
+}
+
+bool check(Manager& entMan, const char* when) {
+    if(!matchesView<Movement, Position, Velocity>(entMan) || !matchesView<Damage, Health>(entMan) || entMan.getSystem<Idle>().getEntities().getSize() != 0) {
+        std::cout << "Membership doesn't match the views " << when << '\n';
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    std::mt19937 random(3);
+    Manager entMan;
+    entMan.registerSystem<Idle>();
+    entMan.registerSystem<Damage>();
+    std::vector<emerald_entity> ids;
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Position>(id, 0.0f);
+        if(i % 2 == 0) {
+            entMan.createComponent<Velocity>(id, 1.0f);
+        }
+        if(i % 5 == 0) {
+            entMan.createComponent<Health>(id, (int)(random() % 10 + 1));
+        }
+        ids.push_back(id);
+    }
+    // Registering after the entities exist picks them up too
+    entMan.registerSystem<Movement>();
+    if(!check(entMan, "after registering")) {
+        return 1;
+    }
+
+    for(auto i = 0; i < entity_count; i++) {
+        auto& id = ids[random() % entity_count];
+        switch(random() % 4) {
+        case 0:
+            entMan.removeEntity(id);
+            id = entMan.createEntity();
+            entMan.createComponent<Velocity>(id, 1.0f);
+            entMan.createComponent<Position>(id, 0.0f);
+            break;
+        case 1:
+            entMan.removeComponent<Velocity>(id);
+            break;
+        case 2:
+            if(entMan.isEntityValid(id)) {
+                entMan.createComponent<Velocity>(id, 2.0f);
+            }
+            break;
+        default:
+            entMan.removeComponent<Position>(id);
+        }
+    }
+    if(!check(entMan, "after churn")) {
+        return 1;
+    }
+
+    for(auto frame = 0; frame < 10; frame++) {
+        entMan.updateSystems();
+    }
+    if(entMan.getSystem<Damage>().getEntities().getSize() != 0 || !check(entMan, "after commands")) {
+        std::cout << "Damage left " << entMan.getSystem<Damage>().getEntities().getSize() << " entities alive\n";
+        return 1;
+    }
+
+    auto members = entMan.getSystem<Movement>().getEntities().getSize();
+    entMan.saveSnapshot(snapshot_path);
+    for(auto i = 0; i < entity_count; i += 10) {
+        entMan.removeEntity(ids[i]);
+    }
+    entMan.loadSnapshot(snapshot_path);
+    std::remove(snapshot_path);
+    if(entMan.getSystem<Movement>().getEntities().getSize() != members || !check(entMan, "after loading")) {
+        return 1;
+    }
+
+    // Walking the members against walking a subscription set and probing the pools
+    std::set<emerald_entity> subscribed;
+    entMan.getSystem<Movement>().getEntities().map([&subscribed](emerald_entity id) {
+        subscribed.insert(id);
+    });
+    auto start = std::chrono::steady_clock::now();
+    entMan.getSystem<Movement>().update(entMan);
+    auto membershipTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for(auto id : subscribed) {
+        if(entMan.entityHasComponents<Position, Velocity>(id)) {
+            entMan.getComponent<Position>(id).m_val += entMan.getComponent<Velocity>(id).m_val;
+        }
+    }
+    auto setTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << members << " members, membership " << membershipTime << "us, set " << setTime << "us\n";
+}
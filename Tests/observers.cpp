@@ -0,0 +1,73 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <unordered_set>
+
+using namespace Emerald;
+
+class Collider {
+public:
+    Collider(float radius) : m_radius(radius) {};
+    float m_radius;
+};
+
+template<>
+struct Emerald::PoolTraits<Collider> {
+    static constexpr PoolLayout layout = PoolLayout::Stable;
+    static constexpr bool track_changes = true;
+};
+
+using Manager = EntityManager<Collider>;
+
+constexpr int entity_count = 100000;
+
+// Keeps a broadphase index of every collider up to date from the batches instead of rescanning
+class Broadphase {
+public:
+    Broadphase(Manager& entMan) {
+        entMan.onAdd<Collider>([this](const std::vector<emerald_entity>& ids) {
+            m_colliders.insert(ids.begin(), ids.end());
+        });
+        entMan.onRemove<Collider>([this](const std::vector<emerald_entity>& ids) {
+            for(auto id : ids) {
+                m_colliders.erase(id);
+            }
+        });
+        entMan.onUpdate<Collider>([this](const std::vector<emerald_entity>& ids) {
+            m_moved += ids.size();
+        });
+    }
+
+    std::unordered_set<emerald_entity> m_colliders;
+    std::size_t m_moved = 0;
+};
+
+int main() {
+    Manager entMan;
+    Broadphase broadphase(entMan);
+    std::vector<emerald_entity> ids;
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Collider>(id, 1.0f);
+        ids.push_back(id);
+    }
+    entMan.updateSystems();
+    broadphase.m_moved = 0;
+
+    for(auto i = 0; i < entity_count; i += 10) {
+        entMan.removeEntity(ids[i]);
+    }
+    for(auto i = 1; i < entity_count; i += 100) {
+        entMan.getComponent<Collider>(ids[i]).m_radius = 2.0f;
+        entMan.markChanged<Collider>(ids[i]);
+    }
+    auto start = std::chrono::steady_clock::now();
+    entMan.updateSystems();
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if(broadphase.m_colliders.size() != entity_count - entity_count / 10 || broadphase.m_moved != entity_count / 100) {
+        std::cout << "Broadphase out of date, " << broadphase.m_colliders.size() << " colliders and " << broadphase.m_moved << " moved\n";
+        return 1;
+    }
+    std::cout << "Events flushed in " << time << "us\n";
+}
@@ -0,0 +1,121 @@
+#define EMERALD_PROFILE
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Velocity {
+public:
+    Velocity(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Lifetime {
+public:
+    Lifetime(int frames) : m_frames(frames) {};
+    int m_frames;
+};
+
+using Manager = EntityManager<Position, Velocity, Lifetime>;
+
+constexpr int entity_count = 100000;
+constexpr int frames = 100;
+const char* trace_path = "profile.json";
+
+class Movement : public ISystem<Movement, Reads<Velocity>, Writes<Position>> {
+public:
+    void update(Manager& entMan) {
+        entMan.view<Position, const Velocity>().map([](emerald_entity, Position& pos, const Velocity& vel) {
+            pos.m_val += vel.m_val;
+        });
+    }
+};
+
+// Spikes every tenth frame
+class Pathfinding : public ISystem<Pathfinding, Reads<Position>> {
+public:
+    void update(Manager& entMan) {
+        auto rounds = ++m_frame % 10 == 0 ? 20 : 1;
+        for(auto round = 0; round < rounds; round++) {
+            entMan.view<const Position>().map([this](emerald_entity, const Position& pos) {
+                m_total += pos.m_val;
+            });
+        }
+    }
+    int m_frame = 0;
+    float m_total = 0;
+};
+
+class Expiry : public ISystem<Expiry, Writes<Lifetime>> {
+public:
+    void update(Manager& entMan) {
+        auto& commands = entMan.getCommandBuffer();
+        entMan.view<Lifetime>().map([&commands](emerald_entity id, Lifetime& lifetime) {
+            if(--lifetime.m_frames == 0) {
+                commands.removeEntity(id);
+                auto spawned = commands.createEntity();
+                commands.createComponent<Lifetime>(spawned, 1);
+            }
+        });
+    }
+};
+
+// Split across the workers, their visits still count for the system
+class Drag : public ISystem<Drag, Writes<Velocity>> {
+public:
+    void update(Manager& entMan) {
+        entMan.parallelMapComponents<Velocity>([](Velocity& vel) {
+            vel.m_val *= 0.99f;
+        }, 256);
+    }
+};
+
+int main() {
+    Manager entMan;
+    entMan.setWorkerCount(2);
+    entMan.registerSystem<Movement>();
+    entMan.registerSystem<Pathfinding>();
+    entMan.registerSystem<Expiry>();
+    entMan.registerSystem<Drag>();
+    entMan.createEntities(entity_count, [&entMan](emerald_entity id, std::size_t i) {
+        entMan.createComponent<Position>(id, 0.0f);
+        entMan.createComponent<Velocity>(id, 1.0f);
+        if(i % 100 == 0) {
+            entMan.createComponent<Lifetime>(id, i % 1000 + 1);
+        }
+    });
+
+    for(auto frame = 0; frame < frames; frame++) {
+        entMan.updateSystems();
+    }
+    auto& profiler = entMan.getProfiler();
+    profiler.report(std::cout);
+    profiler.writeChromeTrace(trace_path);
+
+    std::ifstream file(trace_path);
+    std::stringstream trace;
+    trace << file.rdbuf();
+    file.close();
+    std::remove(trace_path);
+
+    auto& systems = profiler.getSystems();
+    if(systems.size() != 4 || systems[0].name != "Movement" || systems[1].updates != frames || systems[0].visited != entity_count
+        || systems[1].time.max() < systems[1].time.percentile(0.5) * 5 || systems[2].changes == 0
+        || systems[3].visited != entity_count) {
+        std::cout << "Profile doesn't match the systems\n";
+        return 1;
+    }
+    if(trace.str().find("\"name\":\"Pathfinding\"") == std::string::npos || trace.str().find("\"name\":\"flushCommands\"") == std::string::npos) {
+        std::cout << "Trace is missing spans\n";
+        return 1;
+    }
+}
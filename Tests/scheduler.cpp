@@ -0,0 +1,124 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Velocity {
+public:
+    Velocity(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Health {
+public:
+    Health(int val) : m_val(val) {};
+    int m_val;
+};
+
+using Manager = EntityManager<Position, Velocity, Health>;
+
+std::atomic<int> updateOrder(0);
+std::atomic<int> inFlight(0);
+std::atomic<int> mostInFlight(0);
+
+// Holds a system in its update until another one is running alongside it, or a second passes
+void overlap() {
+    auto running = ++inFlight;
+    for(auto most = mostInFlight.load(); most < running && !mostInFlight.compare_exchange_weak(most, running);) {}
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while(mostInFlight < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    inFlight--;
+}
+
+class Movement : public ISystem<Movement, Reads<Velocity>, Writes<Position>> {
+public:
+    void update(Manager& entMan) {
+        entMan.mapComponents<Position, Velocity>([](auto& pos, auto& vel) {
+            pos.m_val += vel.m_val;
+        });
+        overlap();
+        m_order = updateOrder++;
+    }
+    int m_order;
+};
+
+class Regen : public ISystem<Regen, Writes<Health>> {
+public:
+    void update(Manager& entMan) {
+        entMan.mapComponents<Health>([](auto& health) {
+            health.m_val++;
+        });
+        overlap();
+        m_order = updateOrder++;
+    }
+    int m_order;
+};
+
+// Takes its place when it starts, so it has to come after Movement finished
+class Render : public ISystem<Render, Reads<Position>> {
+public:
+    void update(Manager&) {
+        m_order = updateOrder++;
+    }
+    int m_order;
+};
+
+int main() {
+    Manager entMan;
+    entMan.setWorkerCount(2);
+    entMan.registerSystem<Movement>();
+    entMan.registerSystem<Regen>();
+    entMan.registerSystem<Render>();
+    for(auto i = 0; i < 1000; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Position>(id, 0.0f);
+        entMan.createComponent<Velocity>(id, 1.0f);
+        entMan.createComponent<Health>(id, i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    entMan.updateSystems();
+    std::cout << "Update took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << "ms\n";
+
+    std::cout << "Movement " << entMan.getSystem<Movement>().m_order
+              << " Regen " << entMan.getSystem<Regen>().m_order
+              << " Render " << entMan.getSystem<Render>().m_order << '\n';
+    if(entMan.getSystem<Render>().m_order < entMan.getSystem<Movement>().m_order) {
+        std::cout << "Render ran before Movement\n";
+        return 1;
+    }
+    if(mostInFlight < 2) {
+        std::cout << "Movement and Regen didn't run at the same time\n";
+        return 1;
+    }
+
+    // A throw on any thread comes out of the parallel map once the other chunks have stopped
+    try {
+        entMan.parallelMapComponents<Health>([](Health& health) {
+            if(health.m_val == 700) {
+                throw std::runtime_error("Health 700");
+            }
+        }, 64);
+        std::cout << "Parallel map swallowed an exception\n";
+        return 1;
+    } catch(const std::runtime_error&) {}
+    std::atomic<int> visited(0);
+    entMan.parallelMapComponents<Health>([&visited](Health&) {
+        visited++;
+    }, 64);
+    if(visited != 1000) {
+        std::cout << "Parallel map visited " << visited << " after an exception\n";
+        return 1;
+    }
+}
@@ -0,0 +1,152 @@
+#define EMERALD_MAX_COMPONENTS 4
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Velocity {
+public:
+    Velocity(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Health {
+public:
+    Health(int val) : m_val(val) {};
+    int m_val;
+};
+
+// Not declared with the manager, so it gets the next free bit
+class Burning {
+public:
+    Burning(int val) : m_val(val) {};
+    int m_val;
+};
+
+class Frozen {
+public:
+    Frozen(int val) : m_val(val) {};
+    int m_val;
+};
+
+using Manager = EntityManager<Position, Velocity, Health>;
+
+constexpr int entity_count = 500000;
+
+template<typename... comp_ts>
+std::vector<emerald_entity> scanned(Manager& entMan) {
+    std::vector<emerald_entity> ids;
+    entMan.mapEntities<comp_ts...>([&ids](emerald_entity id) {
+        ids.push_back(id);
+    });
+    return ids;
+}
+
+template<typename... comp_ts>
+std::vector<emerald_entity> viewed(Manager& entMan) {
+    std::vector<emerald_entity> ids;
+    entMan.view<comp_ts...>().map([&ids](emerald_entity id, comp_ts&...) {
+        ids.push_back(id);
+    });
+    std::sort(ids.begin(), ids.end(), [](emerald_entity a, emerald_entity b) {
+        return entityIndex(a) < entityIndex(b);
+    });
+    return ids;
+}
+
+bool check(Manager& entMan, const char* when) {
+    if(scanned<Position, Velocity>(entMan) != viewed<Position, Velocity>(entMan) || scanned<Health, Burning>(entMan) != viewed<Health, Burning>(entMan)
+        || scanned<Velocity>(entMan) != viewed<Velocity>(entMan)) {
+        std::cout << "Signature scan doesn't match the views " << when << '\n';
+        return false;
+    }
+    return true;
+}
+
+// Churns a world with IDs being recycled and checks the signatures agree with the pools
+int main() {
+    std::mt19937 random(5);
+    Manager entMan;
+    std::vector<emerald_entity> ids;
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Position>(id, 0.0f);
+        if(i % 2 == 0) {
+            entMan.createComponent<Velocity>(id, 1.0f);
+        }
+        if(i % 3 == 0) {
+            entMan.createComponent<Health>(id, 10);
+        }
+        if(i % 7 == 0) {
+            entMan.createComponent<Burning>(id, 1);
+        }
+        ids.push_back(id);
+    }
+    if(!check(entMan, "after spawning") || !entMan.getSignature(ids[42]).test(3) || entMan.getSignature(ids[1]).test(1)) {
+        return 1;
+    }
+
+    for(auto i = 0; i < entity_count; i++) {
+        auto& id = ids[random() % entity_count];
+        switch(random() % 3) {
+        case 0:
+            entMan.removeEntity(id);
+            id = entMan.createEntity();
+            if(!entMan.getSignature(id).none()) {
+                std::cout << "Recycled entity kept its signature\n";
+                return 1;
+            }
+            entMan.createComponent<Health>(id, 10);
+            break;
+        case 1:
+            entMan.removeComponent<Position>(id);
+            break;
+        default:
+            if(entMan.isEntityValid(id)) {
+                entMan.createComponent<Velocity>(id, 1.0f);
+                entMan.removeComponent<Burning>(id);
+            }
+        }
+    }
+    if(!check(entMan, "after churn")) {
+        return 1;
+    }
+    for(auto id : ids) {
+        if(entMan.isEntityValid(id) && entMan.entityHasComponents<Position, Velocity>(id)
+            != (entMan.entityHasComponent<Position>(id) != invalid_id && entMan.entityHasComponent<Velocity>(id) != invalid_id)) {
+            std::cout << "entityHasComponents disagrees with the pools\n";
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto scan = scanned<Position, Velocity>(entMan).size();
+    auto scanTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    std::size_t probed = 0;
+    entMan.mapEntities([&entMan, &probed](emerald_entity id) {
+        probed += entMan.entityHasComponent<Position>(id) != invalid_id && entMan.entityHasComponent<Velocity>(id) != invalid_id;
+    });
+    auto probeTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << scan << " matches, signature scan " << scanTime << "us, probing pools " << probeTime << "us\n";
+
+    // Only one bit is left past the three registered components and Burning took it
+    auto fresh = entMan.createEntity();
+    try {
+        entMan.createComponent<Frozen>(fresh, 1);
+        std::cout << "Ran out of signature bits without an error\n";
+        return 1;
+    } catch(const BadComponent&) {}
+    if(scan != probed || entMan.entityHasComponents<Frozen>(fresh)) {
+        return 1;
+    }
+}
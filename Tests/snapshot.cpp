@@ -0,0 +1,185 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <typeinfo>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float x, float y) : m_x(x), m_y(y) {};
+    float m_x, m_y;
+};
+
+class Name {
+public:
+    Name(std::string name) : m_name(std::move(name)) {};
+    Name(Name&&) noexcept = default;
+    std::string m_name;
+};
+
+template<>
+struct Emerald::Serializer<Name> {
+    static void write(SnapshotWriter& writer, const Name& name) {
+        writer.write(name.m_name);
+    }
+
+    static Name read(SnapshotReader& reader) {
+        return Name(reader.readString());
+    }
+};
+
+using Manager = EntityManager<Position, Name>;
+
+constexpr int entity_count = 1000000;
+const char* snapshot_path = "snapshot.emerald";
+
+enum class LoadResult {
+    Loaded,
+    Rejected,
+    Broken
+};
+
+// Loads bytes into a manager that already has an entity. A snapshot rejected by its header leaves the manager as it
+// was and one rejected past it leaves it empty, a loaded one has to have every component owned by a live entity
+LoadResult tryLoad(const std::vector<char>& bytes) {
+    std::ofstream(snapshot_path, std::ios::binary).write(bytes.data(), bytes.size());
+    Manager manager;
+    manager.createComponent<Position>(manager.createEntity(), 0.0f, 0.0f);
+    try {
+        manager.loadSnapshot(snapshot_path);
+    } catch(const BadSnapshot&) {
+        auto untouched = manager.getEntityCount() == 1 && manager.getPoolStats().live == 1;
+        auto empty = manager.getEntityCount() == 0 && manager.getPoolStats().live == 0;
+        return untouched || empty ? LoadResult::Rejected : LoadResult::Broken;
+    }
+    auto owned = true;
+    manager.view<const Position>().map([&manager, &owned](emerald_entity id, const Position&) {
+        owned = owned && manager.isEntityValid(id);
+    });
+    manager.view<const Name>().map([&manager, &owned](emerald_entity id, const Name&) {
+        owned = owned && manager.isEntityValid(id);
+    });
+    return owned ? LoadResult::Loaded : LoadResult::Broken;
+}
+
+// Where the free entity count starts in a snapshot with entities slots, past the header and the entity table
+std::size_t freeListOffset(const std::size_t entities) {
+    auto offset = sizeof(snapshot_magic) + 3 * sizeof(uint32_t);
+    for(auto name : {typeid(Position).name(), typeid(Name).name()}) {
+        offset += sizeof(uint64_t) + std::strlen(name);
+    }
+    return offset + sizeof(uint64_t) + entities * sizeof(emerald_entity);
+}
+
+// Every cut short and every single corrupted byte of a small snapshot either loads or is rejected cleanly
+bool rejectsCorruption() {
+    Manager small;
+    for(auto i = 0; i < 6; i++) {
+        auto id = small.createEntity();
+        small.createComponent<Position>(id, (float)i, 0.0f);
+        if(i % 2 == 0) {
+            small.createComponent<Name>(id, "entity " + std::to_string(i));
+        }
+    }
+    small.removeEntity(makeEntity(1, 0));
+    small.removeEntity(makeEntity(3, 0));
+    small.saveSnapshot(snapshot_path);
+    std::ifstream in(snapshot_path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    if(tryLoad(bytes) != LoadResult::Loaded) {
+        std::cout << "Small snapshot didn't load\n";
+        return false;
+    }
+
+    // A free slot listed twice would be handed out twice, one left off would leak
+    auto freeList = freeListOffset(6);
+    uint64_t freeCount = 0;
+    std::memcpy(&freeCount, bytes.data() + freeList, sizeof(freeCount));
+    if(freeCount != 2) {
+        std::cout << "Snapshot free list isn't where it was expected\n";
+        return false;
+    }
+    auto first = freeList + sizeof(uint64_t);
+    auto twice = bytes;
+    std::memcpy(twice.data() + first + sizeof(emerald_id), twice.data() + first, sizeof(emerald_id));
+    auto missing = bytes;
+    freeCount = 1;
+    std::memcpy(missing.data() + freeList, &freeCount, sizeof(freeCount));
+    missing.erase(missing.begin() + first + sizeof(emerald_id), missing.begin() + first + 2 * sizeof(emerald_id));
+    if(tryLoad(twice) != LoadResult::Rejected || tryLoad(missing) != LoadResult::Rejected) {
+        std::cout << "Snapshot with a duplicate or missing free entity wasn't rejected\n";
+        return false;
+    }
+
+    std::size_t rejected = 0;
+    for(std::size_t size = 0; size < bytes.size(); size++) {
+        if(tryLoad(std::vector<char>(bytes.begin(), bytes.begin() + size)) != LoadResult::Rejected) {
+            std::cout << "Snapshot cut to " << size << " bytes wasn't rejected\n";
+            return false;
+        }
+    }
+    for(std::size_t i = 0; i < bytes.size(); i++) {
+        auto corrupt = bytes;
+        corrupt[i] = (char)0xFF;
+        auto result = tryLoad(corrupt);
+        if(result == LoadResult::Broken) {
+            std::cout << "Corrupting byte " << i << " broke the manager\n";
+            return false;
+        }
+        rejected += result == LoadResult::Rejected;
+    }
+    std::remove(snapshot_path);
+    return rejected > 0;
+}
+
+// Saves a large world and loads it into another manager, against rebuilding it one entity at a time
+int main() {
+    if(!rejectsCorruption()) {
+        return 1;
+    }
+
+    Manager world;
+    auto start = std::chrono::steady_clock::now();
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = world.createEntity();
+        world.createComponent<Position>(id, (float)i, 0.0f);
+        if(i % 100 == 0) {
+            world.createComponent<Name>(id, "entity " + std::to_string(i));
+        }
+    }
+    for(auto i = 0; i < entity_count; i += 7) {
+        world.removeEntity(makeEntity(i, 0));
+    }
+    auto buildTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    world.saveSnapshot(snapshot_path);
+    auto saveTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    Manager restored;
+    start = std::chrono::steady_clock::now();
+    restored.loadSnapshot(snapshot_path);
+    auto loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::remove(snapshot_path);
+
+    std::size_t mismatches = 0;
+    world.mapEntities([&world, &restored, &mismatches](const emerald_entity id) {
+        if(!restored.isEntityValid(id) || restored.getComponent<Position>(id).m_x != world.getComponent<Position>(id).m_x
+            || restored.entityHasComponent<Name>(id) != world.entityHasComponent<Name>(id)
+            || (world.entityHasComponents<Name>(id) && restored.getComponent<Name>(id).m_name != world.getComponent<Name>(id).m_name)) {
+            mismatches++;
+        }
+    });
+    auto id = restored.createEntity();
+    if(mismatches > 0 || restored.getEntityCount() != world.getEntityCount() + 1 || id != world.createEntity()) {
+        std::cout << "Restored world doesn't match, " << mismatches << " mismatches\n";
+        return 1;
+    }
+    std::cout << "Built in " << buildTime << "ms, saved in " << saveTime << "ms, loaded in " << loadTime << "ms\n";
+}
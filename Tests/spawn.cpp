@@ -0,0 +1,73 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float x, float y) : m_x(x), m_y(y) {};
+    float m_x, m_y;
+};
+
+class Velocity {
+public:
+    Velocity(float x, float y) : m_x(x), m_y(y) {};
+    float m_x, m_y;
+};
+
+class Lifetime {
+public:
+    Lifetime(int frames) : m_frames(frames) {};
+    int m_frames;
+};
+
+using Manager = EntityManager<Position, Velocity, Lifetime>;
+
+constexpr int entity_count = 50000;
+
+// Spawns a burst of particles one entity at a time and then with the bulk calls
+int main() {
+    Manager single;
+    auto start = std::chrono::steady_clock::now();
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = single.createEntity();
+        single.createComponent<Position>(id, 0.0f, 0.0f);
+        single.createComponent<Velocity>(id, 1.0f, 1.0f);
+        single.createComponent<Lifetime>(id, 60);
+    }
+    auto singleTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    Manager bulk;
+    start = std::chrono::steady_clock::now();
+    auto ids = bulk.createEntitiesWith(entity_count, Position(0.0f, 0.0f), Velocity(1.0f, 1.0f), Lifetime(60));
+    auto bulkTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if(ids.size() != entity_count || bulk.getEntityCount() != entity_count || !bulk.entityHasComponents<Position, Velocity, Lifetime>(ids.back())) {
+        std::cout << "Bulk creation failed\n";
+        return 1;
+    }
+    std::cout << entity_count << " entities one at a time in " << singleTime << "us, in bulk in " << bulkTime << "us\n";
+
+    // Refilling the holes left by removed entities doesn't grow the pools
+    for(auto i = 0; i < entity_count; i += 2) {
+        bulk.removeEntity(ids[i]);
+    }
+    auto capacity = bulk.getPoolStats<Position>().capacity;
+    bulk.createEntitiesWith(entity_count / 2, Position(0.0f, 0.0f));
+    if(bulk.getPoolStats<Position>().capacity != capacity) {
+        std::cout << "Bulk creation grew a pool with room to spare\n";
+        return 1;
+    }
+
+    // Once reserved the entity tables don't move while entities are created one at a time
+    bulk.reserveEntities(entity_count);
+    const auto* signature = &bulk.getSignature(ids[1]);
+    for(auto i = 0; i < entity_count; i++) {
+        bulk.createEntity();
+    }
+    if(&bulk.getSignature(ids[1]) != signature) {
+        std::cout << "Reserved entity tables were reallocated\n";
+        return 1;
+    }
+}
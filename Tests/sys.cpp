@@ -33,24 +33,26 @@ private:
     emerald_id m_val;
 };
 
+using Manager = EntityManager<ComponentA, ComponentB>;
+
 class System : public ISystem<System> {
 public:
-    void update(EntityManager& entMan) {
+    void update(Manager&) {
 
     }
 };
 
 int main() {
-    EntityManager entMan;
+    Manager entMan;
     entMan.registerSystem<System>();
     for(auto i = 0; i < 100; i++) {
         auto id = entMan.createEntity();
         std::cout << id << '\n';
-        entMan.createComponent<ComponentA>(id, id);
+        entMan.createComponent<ComponentA>(id, i);
         if(i % 2 == 0) {
-            entMan.createComponent<ComponentB>(id, id);
+            entMan.createComponent<ComponentB>(id, i);
         }
     }
-    entMan.removeEntity(20);
-    entMan.updateSystems(1.0f);
+    entMan.removeEntity(makeEntity(20, 0));
+    entMan.updateSystems();
 }
@@ -0,0 +1,115 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <cstdio>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Enemy {};
+class Selected {};
+
+// The smallest component that isn't a tag
+class Marker {
+public:
+    char m_val = 0;
+};
+
+class Clock {
+public:
+    Clock(double delta) : m_delta(delta) {};
+    double m_delta;
+    long m_frame = 0;
+};
+
+class Input {
+public:
+    bool m_fire = false;
+};
+
+using Manager = EntityManager<Position, Enemy, Marker>;
+
+constexpr int entity_count = 300000;
+const char* snapshot_path = "tags.emerald";
+
+class Shooting : public ISystem<Shooting, Reads<Position, Enemy>> {
+public:
+    void update(Manager& entMan) {
+        auto& clock = entMan.singleton<Clock>();
+        clock.m_frame++;
+        if(entMan.singleton<Input>().m_fire) {
+            m_entities.map([this](emerald_entity) {
+                m_shots++;
+            });
+        }
+    }
+    std::size_t m_shots = 0;
+};
+
+int main() {
+    Manager entMan;
+    entMan.emplaceSingleton<Clock>(1.0 / 60);
+    entMan.registerSystem<Shooting>();
+    std::vector<emerald_entity> ids;
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Position>(id, (float)i);
+        if(i % 4 == 0) {
+            entMan.createComponent<Enemy>(id);
+            entMan.createComponent<Marker>(id);
+        }
+        if(i % 100 == 0) {
+            entMan.createComponent<Selected>(id);
+        }
+        ids.push_back(id);
+    }
+    for(auto i = 0; i < entity_count; i += 8) {
+        entMan.removeComponent<Enemy>(ids[i]);
+        entMan.removeComponent<Marker>(ids[i]);
+    }
+
+    auto tags = entMan.getPoolStats<Enemy>();
+    auto markers = entMan.getPoolStats<Marker>();
+    std::cout << "Tag pool " << tags.bytes / 1024 << "KB for " << tags.live << ", marker pool " << markers.bytes / 1024 << "KB for " << markers.live << '\n';
+    std::size_t enemies = 0;
+    entMan.view<const Position, const Enemy>().map([&enemies](emerald_entity, const Position& pos, const Enemy&) {
+        enemies += (int)pos.m_val % 8 == 4;
+    });
+    if(tags.live != entity_count / 8 || enemies != tags.live || !entMan.entityHasComponents<Enemy, Selected>(ids[100])
+        || entMan.entityHasComponents<Enemy>(ids[8]) || tags.bytes != 0 || entMan.getPoolStats<Selected>().bytes != 0) {
+        std::cout << "Tags don't match\n";
+        return 1;
+    }
+
+    entMan.saveSnapshot(snapshot_path);
+    Manager restored;
+    restored.loadSnapshot(snapshot_path);
+    std::remove(snapshot_path);
+    std::size_t restoredEnemies = 0;
+    restored.view<const Enemy>().map([&restoredEnemies](emerald_entity, const Enemy&) {
+        restoredEnemies++;
+    });
+    if(restoredEnemies != enemies || restored.getPoolStats<Enemy>().live != enemies || !restored.entityHasComponents<Enemy>(ids[4])
+        || restored.entityHasComponents<Enemy>(ids[8]) || restored.getPoolStats<Enemy>().bytes != 0) {
+        std::cout << "Restored tags don't match\n";
+        return 1;
+    }
+
+    entMan.updateSystems();
+    entMan.singleton<Input>().m_fire = true;
+    entMan.updateSystems();
+    const auto& constMan = entMan;
+    if(entMan.getSystem<Shooting>().m_shots != enemies || constMan.singleton<Clock>().m_frame != 2 || !entMan.hasSingleton<Input>()) {
+        std::cout << "Singletons don't match\n";
+        return 1;
+    }
+    entMan.emplaceSingleton<Clock>(1.0 / 30);
+    if(entMan.singleton<Clock>().m_frame != 0 || entMan.singleton<Clock>().m_delta != 1.0 / 30) {
+        std::cout << "Singleton wasn't replaced\n";
+        return 1;
+    }
+}
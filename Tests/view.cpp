@@ -0,0 +1,99 @@
+#include "../Emerald/entitymanager.hh"
+#include <iostream>
+#include <chrono>
+#include <functional>
+
+using namespace Emerald;
+
+class Position {
+public:
+    Position(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Velocity {
+public:
+    Velocity(float val) : m_val(val) {};
+    float m_val;
+};
+
+class Frozen {
+public:
+    Frozen(int val) : m_val(val) {};
+    int m_val;
+};
+
+using Manager = EntityManager<Position, Velocity, Frozen>;
+
+constexpr int entity_count = 200000;
+constexpr int rounds = 20;
+
+template<typename func_t>
+void benchmark(const char* name, func_t func) {
+    auto start = std::chrono::steady_clock::now();
+    for(auto round = 0; round < rounds; round++) {
+        func();
+    }
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << (double)time / rounds << "us\n";
+}
+
+// Every entity moves, one in ten is also frozen. Compares walking the entity table through std::function
+// like mapComponents used to with the view joins
+int main() {
+    Manager entMan;
+    for(auto i = 0; i < entity_count; i++) {
+        auto id = entMan.createEntity();
+        entMan.createComponent<Position>(id, 0.0f);
+        entMan.createComponent<Velocity>(id, 1.0f);
+        if(i % 10 == 0) {
+            entMan.createComponent<Frozen>(id, i);
+        }
+    }
+
+    std::function<void(Position&, Velocity&)> move = [](Position& pos, Velocity& vel) {
+        pos.m_val += vel.m_val;
+    };
+    benchmark("Entity table with std::function", [&entMan, &move] {
+        entMan.mapEntities([&entMan, &move](const emerald_entity id) {
+            if(entMan.entityHasComponents<Position, Velocity>(id)) {
+                move(entMan.getComponent<Position>(id), entMan.getComponent<Velocity>(id));
+            }
+        });
+    });
+    benchmark("view<Position, Velocity>().map", [&entMan] {
+        entMan.view<Position, Velocity>().map([](emerald_entity, Position& pos, Velocity& vel) {
+            pos.m_val += vel.m_val;
+        });
+    });
+    benchmark("view<Position, Velocity> range for", [&entMan] {
+        for(auto [id, pos, vel] : entMan.view<Position, Velocity>()) {
+            pos.m_val += vel.m_val;
+        }
+    });
+
+    std::function<void(Position&, Frozen&)> thaw = [](Position& pos, Frozen& frozen) {
+        pos.m_val -= frozen.m_val;
+    };
+    benchmark("Entity table with std::function, frozen", [&entMan, &thaw] {
+        entMan.mapEntities([&entMan, &thaw](const emerald_entity id) {
+            if(entMan.entityHasComponents<Position, Frozen>(id)) {
+                thaw(entMan.getComponent<Position>(id), entMan.getComponent<Frozen>(id));
+            }
+        });
+    });
+    benchmark("view<Position, Frozen>().map", [&entMan] {
+        entMan.view<Position, Frozen>().map([](emerald_entity, Position& pos, Frozen& frozen) {
+            pos.m_val -= frozen.m_val;
+        });
+    });
+
+    std::size_t count = 0;
+    entMan.mapComponents<Position, Frozen>([&count](auto&, auto&) {
+        count++;
+    });
+    if(count != entity_count / 10) {
+        std::cout << "Wrong number of frozen entities " << count << '\n';
+        return 1;
+    }
+}